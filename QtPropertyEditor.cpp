@@ -5,22 +5,44 @@
 
 #include "QtPropertyEditor.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <QAbstractButton>
 #include <QApplication>
+#include <QChildEvent>
+#include <QClipboard>
+#include <QColorDialog>
 #include <QComboBox>
+#include <QDataStream>
+#include <QElapsedTimer>
 #include <QEvent>
+#include <QFile>
 #include <QHeaderView>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QKeyEvent>
 #include <QLineEdit>
+#include <QListWidget>
 #include <QMenu>
 #include <QMessageBox>
 #include <QMetaObject>
 #include <QMetaType>
 #include <QMouseEvent>
+#include <QMutex>
+#include <QPainter>
+#include <QPixmapCache>
 #include <QPushButton>
 #include <QRegularExpression>
 #include <QScrollBar>
+#include <QSequentialIterable>
+#include <QSet>
+#include <QStringDecoder>
 #include <QStylePainter>
+#include <QThread>
 #include <QToolButton>
+#include <QtNumeric>
+#include <QWaitCondition>
 
 #include <QSpacerItem>
 
@@ -87,6 +109,333 @@ namespace QtPropertyEditor
         return QSize(w, h);
     }
     
+    static bool isNumericTypeId(int typeId)
+    {
+        switch(typeId) {
+            case QMetaType::Int:
+            case QMetaType::UInt:
+            case QMetaType::Long:
+            case QMetaType::ULong:
+            case QMetaType::LongLong:
+            case QMetaType::ULongLong:
+            case QMetaType::Short:
+            case QMetaType::UShort:
+            case QMetaType::Float:
+            case QMetaType::Double:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    // Keys of a flag enum built once per QMetaEnum so that rendering and editing never split or look up key strings.
+    struct FlagKeyTable
+    {
+        QVector<int> masks; // Non-zero key values in declaration order.
+        QStringList keys;
+        QString zeroKey; // Key for no flags set (if any).
+    };
+    
+    static FlagKeyTable flagKeyTable(const QMetaEnum &metaEnum)
+    {
+        // Locked as text conversion is also used by background exports (tables are implicitly shared, so copies are cheap).
+        static QHash<QByteArray, FlagKeyTable> tables;
+        static QMutex mutex;
+        QMutexLocker locker(&mutex);
+        QByteArray enumName = QByteArray(metaEnum.scope()) + QByteArray("::") + QByteArray(metaEnum.name());
+        auto it = tables.find(enumName);
+        if(it == tables.end()) {
+            FlagKeyTable table;
+            int numKeys = metaEnum.keyCount();
+            for(int i = 0; i < numKeys; ++i) {
+                int mask = metaEnum.value(i);
+                if(mask == 0) {
+                    table.zeroKey = QString(metaEnum.key(i));
+                } else {
+                    table.masks.append(mask);
+                    table.keys.append(QString(metaEnum.key(i)));
+                }
+            }
+            it = tables.insert(enumName, table);
+        }
+        return it.value();
+    }
+    
+    // Same as QMetaEnum::valueToKeys(), e.g. "AlignLeft|AlignTop".
+    static QString flagsToText(const QMetaEnum &metaEnum, int value)
+    {
+        const FlagKeyTable table = flagKeyTable(metaEnum);
+        if(value == 0)
+            return table.zeroKey;
+        QString text;
+        uint remaining = uint(value);
+        for(int i = table.masks.size() - 1; i >= 0; --i) {
+            uint mask = uint(table.masks.at(i));
+            if((remaining & mask) == mask) {
+                remaining &= ~mask;
+                text = text.isEmpty() ? table.keys.at(i) : table.keys.at(i) + QString("|") + text;
+            }
+        }
+        return text;
+    }
+    
+    // Enum (or flag) of the property at index. Enum types always map to the same QMetaEnum,
+    // so the property is only looked up the first time a type is seen.
+    static QMetaEnum metaEnumAtIndex(const QModelIndex &index, const QVariant &value)
+    {
+        // Locked like flagKeyTable() as the cache is shared by all delegates and models.
+        static QHash<int, QMetaEnum> metaEnums;
+        static QMutex mutex;
+        QMutexLocker locker(&mutex);
+        auto it = metaEnums.constFind(value.typeId());
+        if(it != metaEnums.constEnd())
+            return it.value();
+        const QtAbstractPropertyModel *propertyModel = qobject_cast<const QtAbstractPropertyModel*>(index.model());
+        if(!propertyModel)
+            return QMetaEnum();
+        const QMetaProperty metaProperty = propertyModel->metaPropertyAtIndex(index);
+        if(!metaProperty.isValid() || !metaProperty.isEnumType())
+            return QMetaEnum();
+        return metaEnums.insert(value.typeId(), metaProperty.enumerator()).value();
+    }
+    
+    QString valueToText(const QVariant &value, const QMetaProperty &metaProperty)
+    {
+        if(!value.isValid())
+            return QString();
+        if(metaProperty.isValid() && metaProperty.isFlagType()) {
+            // Flag keys separated by |.
+            return flagsToText(metaProperty.enumerator(), value.toInt());
+        }
+        if(metaProperty.isValid() && metaProperty.isEnumType()) {
+            // Enum key.
+            const QMetaEnum metaEnum = metaProperty.enumerator();
+            return QString(metaEnum.valueToKey(value.toInt()));
+        }
+        switch(value.typeId()) {
+            case QMetaType::QSize: {
+                // w x h
+                QSize size = value.toSize();
+                return QString::number(size.width()) + QString(" x ") + QString::number(size.height());
+            }
+            case QMetaType::QSizeF: {
+                // w x h
+                QSizeF size = value.toSizeF();
+                return QString::number(size.width()) + QString(" x ") + QString::number(size.height());
+            }
+            case QMetaType::QPoint: {
+                // (x, y)
+                QPoint point = value.toPoint();
+                return QString("(")
+                + QString::number(point.x()) + QString(", ") + QString::number(point.y())
+                + QString(")");
+            }
+            case QMetaType::QPointF: {
+                // (x, y)
+                QPointF point = value.toPointF();
+                return QString("(")
+                + QString::number(point.x()) + QString(", ") + QString::number(point.y())
+                + QString(")");
+            }
+            case QMetaType::QRect: {
+                // [(x, y), w x h]
+                QRect rect = value.toRect();
+                return QString("[(")
+                + QString::number(rect.x()) + QString(", ") + QString::number(rect.y())
+                + QString("), ")
+                + QString::number(rect.width()) + QString(" x ") + QString::number(rect.height())
+                + QString("]");
+            }
+            case QMetaType::QRectF: {
+                // [(x, y), w x h]
+                QRectF rect = value.toRectF();
+                return QString("[(")
+                + QString::number(rect.x()) + QString(", ") + QString::number(rect.y())
+                + QString("), ")
+                + QString::number(rect.width()) + QString(" x ") + QString::number(rect.height())
+                + QString("]");
+            }
+            case QMetaType::QColor: {
+                // (r, g, b, a)
+                QColor color = value.value<QColor>();
+                return QString("(")
+                + QString::number(color.red()) + QString(", ") + QString::number(color.green()) + QString(", ")
+                + QString::number(color.blue()) + QString(", ") + QString::number(color.alpha())
+                + QString(")");
+            }
+            default:
+                return value.toString();
+        }
+    }
+    
+    QVariant valueFromText(const QString &text, int typeId, const QMetaProperty &metaProperty, bool *ok)
+    {
+        // Regular expressions are compiled once and shared.
+        // Size formats: (w x h) or (w,h) or (w h) <== () are optional
+        // Point formats: (x,y) or (x y) <== () are optional
+        // Rect formats: [Point,Size] or [Point Size] <== [] are optional
+        static const QRegularExpression intPairRegex("^\\s*\\(?\\s*([\\+\\-]?\\d+)\\s*[x,\\s]\\s*([\\+\\-]?\\d+)\\s*\\)?\\s*$");
+        static const QRegularExpression realPairRegex("^\\s*\\(?\\s*([0-9\\+\\-\\.eE]+)\\s*[x,\\s]\\s*([0-9\\+\\-\\.eE]+)\\s*\\)?\\s*$");
+        static const QRegularExpression intRectRegex("^\\s*\\[?"
+                                                     "\\s*\\(?\\s*([\\+\\-]?\\d+)\\s*[,\\s]\\s*([\\+\\-]?\\d+)\\s*\\)?\\s*"
+                                                     "[,\\s]"
+                                                     "\\s*\\(?\\s*(\\d+)\\s*[x,\\s]\\s*(\\d+)\\s*\\)?\\s*"
+                                                     "\\]?\\s*$");
+        static const QRegularExpression realRectRegex("^\\s*\\[?"
+                                                      "\\s*\\(?\\s*([0-9\\+\\-\\.eE]+)\\s*[,\\s]\\s*([0-9\\+\\-\\.eE]+)\\s*\\)?\\s*"
+                                                      "[,\\s]"
+                                                      "\\s*\\(?\\s*([0-9\\+\\-\\.eE]+)\\s*[x,\\s]\\s*([0-9\\+\\-\\.eE]+)\\s*\\)?\\s*"
+                                                      "\\]?\\s*$");
+        // Color formats: (r,g,b) or (r g b) or (r,g,b,a) or (r g b a) <== () are optional, or a color name such as #rrggbb
+        static const QRegularExpression colorRegex("^\\s*\\(?"
+                                                   "\\s*(\\d+)\\s*"
+                                                   "[,\\s]\\s*(\\d+)\\s*"
+                                                   "[,\\s]\\s*(\\d+)\\s*"
+                                                   "(?:[,\\s]\\s*(\\d+)\\s*)?"
+                                                   "\\)?\\s*$");
+        bool success = false;
+        QVariant value;
+        if(metaProperty.isValid() && metaProperty.isFlagType()) {
+            // Flag keys separated by | (or numeric value).
+            const QMetaEnum metaEnum = metaProperty.enumerator();
+            QByteArray keys = text.trimmed().toLatin1();
+            int flagsValue = keys.isEmpty() ? 0 : metaEnum.keysToValue(keys.constData(), &success);
+            if(keys.isEmpty())
+                success = true;
+            if(!success)
+                flagsValue = keys.toInt(&success);
+            if(success)
+                value = QVariant(flagsValue);
+        } else if(metaProperty.isValid() && metaProperty.isEnumType()) {
+            // Enum key (or numeric value).
+            const QMetaEnum metaEnum = metaProperty.enumerator();
+            QByteArray key = text.trimmed().toLatin1();
+            int enumValue = metaEnum.keyToValue(key.constData(), &success);
+            if(!success)
+                enumValue = key.toInt(&success);
+            if(success)
+                value = QVariant(enumValue);
+        } else if(typeId == QMetaType::QSize || typeId == QMetaType::QPoint || typeId == QMetaType::QSizeF || typeId == QMetaType::QPointF) {
+            bool isReal = (typeId == QMetaType::QSizeF || typeId == QMetaType::QPointF);
+            QRegularExpressionMatch match = (isReal ? realPairRegex : intPairRegex).match(text);
+            if(match.hasMatch()) {
+                bool aok, bok;
+                double a = match.captured(1).toDouble(&aok);
+                double b = match.captured(2).toDouble(&bok);
+                success = aok && bok;
+                if(typeId == QMetaType::QSize)
+                    value = QVariant(QSize(int(a), int(b)));
+                else if(typeId == QMetaType::QSizeF)
+                    value = QVariant(QSizeF(a, b));
+                else if(typeId == QMetaType::QPoint)
+                    value = QVariant(QPoint(int(a), int(b)));
+                else
+                    value = QVariant(QPointF(a, b));
+            }
+        } else if(typeId == QMetaType::QRect || typeId == QMetaType::QRectF) {
+            bool isReal = (typeId == QMetaType::QRectF);
+            QRegularExpressionMatch match = (isReal ? realRectRegex : intRectRegex).match(text);
+            if(match.hasMatch()) {
+                bool xok, yok, wok, hok;
+                double x = match.captured(1).toDouble(&xok);
+                double y = match.captured(2).toDouble(&yok);
+                double w = match.captured(3).toDouble(&wok);
+                double h = match.captured(4).toDouble(&hok);
+                success = xok && yok && wok && hok;
+                if(isReal)
+                    value = QVariant(QRectF(x, y, w, h));
+                else
+                    value = QVariant(QRect(int(x), int(y), int(w), int(h)));
+            }
+        } else if(typeId == QMetaType::QColor) {
+            QRegularExpressionMatch match = colorRegex.match(text);
+            QColor color;
+            if(match.hasMatch()) {
+                int r = match.captured(1).toInt();
+                int g = match.captured(2).toInt();
+                int b = match.captured(3).toInt();
+                int a = match.captured(4).isEmpty() ? 255 : match.captured(4).toInt();
+                if(r <= 255 && g <= 255 && b <= 255 && a <= 255)
+                    color = QColor(r, g, b, a);
+            } else {
+                color = QColor(text.trimmed());
+            }
+            success = color.isValid();
+            value = QVariant(color);
+        } else if(typeId == QMetaType::Bool) {
+            // true/false or 1/0
+            QString str = text.trimmed().toLower();
+            success = (str == "true" || str == "false" || str == "1" || str == "0");
+            value = QVariant(str == "true" || str == "1");
+        } else if(typeId == QMetaType::UnknownType || typeId == QMetaType::QString) {
+            success = true;
+            value = QVariant(text);
+        } else {
+            // Everything else via QVariant's conversion from string (e.g. numbers in scientific notation).
+            value = QVariant(text.trimmed());
+            success = value.convert(QMetaType(typeId));
+        }
+        if(ok)
+            *ok = success;
+        return success ? value : QVariant();
+    }
+    
+    size_t valueHash(const QVariant &value)
+    {
+        // Seeded with the type so that e.g. 1 and true differ.
+        int typeId = value.typeId();
+        switch(typeId) {
+            case QMetaType::UnknownType:
+                return 0;
+            case QMetaType::Bool:
+                return qHash(int(value.toBool()), size_t(typeId));
+            case QMetaType::Int:
+            case QMetaType::Long:
+            case QMetaType::LongLong:
+            case QMetaType::Short:
+                return qHash(value.toLongLong(), size_t(typeId));
+            case QMetaType::UInt:
+            case QMetaType::ULong:
+            case QMetaType::ULongLong:
+            case QMetaType::UShort:
+                return qHash(value.toULongLong(), size_t(typeId));
+            case QMetaType::Float:
+            case QMetaType::Double:
+                return qHash(value.toDouble(), size_t(typeId));
+            case QMetaType::QString:
+                return qHash(value.toString(), size_t(typeId));
+            case QMetaType::QByteArray:
+                return qHash(value.toByteArray(), size_t(typeId));
+            default:
+                if(value.metaType().flags() & QMetaType::IsEnumeration)
+                    return qHash(value.toLongLong(), size_t(typeId));
+                return qHash(valueToText(value), size_t(typeId));
+        }
+    }
+    
+    QtAbstractPropertyModel::QtAbstractPropertyModel(QObject *parent) : QAbstractItemModel(parent)
+    {
+        // The read-only value store is rebuilt on next access whenever the rows change.
+        connect(this, SIGNAL(modelReset()), this, SLOT(invalidateValueStore()));
+        connect(this, SIGNAL(layoutChanged()), this, SLOT(invalidateValueStore()));
+        connect(this, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(valueStoreRowsInserted(QModelIndex, int, int)));
+        connect(this, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(valueStoreRowsRemoved(QModelIndex, int, int)));
+        connect(this, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), this, SLOT(invalidateValueStore()));
+        connect(this, SIGNAL(columnsInserted(QModelIndex, int, int)), this, SLOT(invalidateValueStore()));
+        connect(this, SIGNAL(columnsRemoved(QModelIndex, int, int)), this, SLOT(invalidateValueStore()));
+        
+        // Cached baseline diffs are re-evaluated for changed cells, and all of them whenever the rows change.
+        // Connected before any view so that views see the updated diff.
+        connect(this, SIGNAL(dataChanged(QModelIndex, QModelIndex, QList<int>)), this, SLOT(invalidateChangedCells(QModelIndex, QModelIndex)));
+        connect(this, SIGNAL(modelReset()), this, SLOT(clearChangedCells()));
+        connect(this, SIGNAL(layoutChanged()), this, SLOT(clearChangedCells()));
+        connect(this, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(clearChangedCells()));
+        connect(this, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(clearChangedCells()));
+        connect(this, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), this, SLOT(clearChangedCells()));
+        connect(this, SIGNAL(columnsInserted(QModelIndex, int, int)), this, SLOT(clearChangedCells()));
+        connect(this, SIGNAL(columnsRemoved(QModelIndex, int, int)), this, SLOT(clearChangedCells()));
+    }
+    
     void QtAbstractPropertyModel::setProperties(const QString &str)
     {
         // str = "name0: header0, name1, name2, name3: header3 ..."
@@ -139,20 +488,63 @@ namespace QtPropertyEditor
         if(!index.isValid())
             return QVariant();
         if(role == Qt::DisplayRole || role == Qt::EditRole) {
-            QObject *object = objectAtIndex(index);
-            if(!object)
-                return QVariant();
-            QByteArray propertyName = propertyNameAtIndex(index);
-            if(propertyName.isEmpty())
-                return QVariant();
-            return object->property(propertyName.constData());
+            if(_isReadOnly)
+                return valueFromStore(index);
+            return propertyValue(index);
+        }
+        return baselineData(index, role);
+    }
+    
+    QVariant QtAbstractPropertyModel::propertyValue(const QModelIndex &index) const
+    {
+        QObject *object = objectAtIndex(index);
+        if(!object)
+            return QVariant();
+        QByteArray propertyName = propertyNameAtIndex(index);
+        if(propertyName.isEmpty())
+            return QVariant();
+        return object->property(propertyName.constData());
+    }
+    
+    QVariant QtAbstractPropertyModel::valueFromStore(const QModelIndex &index) const
+    {
+        if(!_isValueStoreValid) {
+            storeValues();
+            _isValueStoreValid = true;
         }
+        return storedValue(index);
+    }
+    
+    void QtAbstractPropertyModel::setReadOnly(bool b)
+    {
+        if(_isReadOnly == b)
+            return;
+        _isReadOnly = b;
+        invalidateValueStore();
+        // Editability of every cell changed.
+        if(rowCount() && columnCount())
+            emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+    }
+    
+    void QtAbstractPropertyModel::refreshValues()
+    {
+        invalidateValueStore();
+        if(rowCount() && columnCount())
+            emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1), QList<int>() << Qt::DisplayRole << Qt::EditRole);
+    }
+    
+    QVariant QtAbstractPropertyModel::baselineData(const QModelIndex &index, int role) const
+    {
+        if(role == ValueChangedRole)
+            return _hasBaseline ? QVariant(isChangedFromBaseline(index)) : QVariant();
+        if(role == Qt::BackgroundRole && _hasBaseline && isChangedFromBaseline(index))
+            return QVariant(changedBackground);
         return QVariant();
     }
     
     bool QtAbstractPropertyModel::setData(const QModelIndex &index, const QVariant &value, int role)
     {
-        if(!index.isValid())
+        if(!index.isValid() || _isReadOnly)
             return false;
         if(role == Qt::EditRole) {
             QObject *object = objectAtIndex(index);
@@ -161,12 +553,7 @@ namespace QtPropertyEditor
             QByteArray propertyName = propertyNameAtIndex(index);
             if(propertyName.isEmpty())
                 return false;
-            bool result = object->setProperty(propertyName.constData(), value);
-            // Result will be FALSE for dynamic properties, which causes the tree view to lag.
-            // So make sure we still return TRUE in this case.
-            if(!result && object->dynamicPropertyNames().contains(propertyName))
-                return true;
-            return result;
+            return writeProperty(index, object, propertyName, value);
         }
         return false;
     }
@@ -176,6 +563,8 @@ namespace QtPropertyEditor
         Qt::ItemFlags flags = QAbstractItemModel::flags(index);
         if(!index.isValid())
             return flags;
+        if(_isReadOnly)
+            return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
         QObject *object = objectAtIndex(index);
         if(!object)
             return flags;
@@ -188,757 +577,3756 @@ namespace QtPropertyEditor
         return flags;
     }
     
-    void QtPropertyTreeModel::Node::setObject(QObject *object, int maxChildDepth, const QList<QByteArray> &propertyNames)
+    bool QtAbstractPropertyModel::isWritableIndex(const QModelIndex &index) const
     {
-        this->object = object;
-        propertyName.clear();
-        qDeleteAll(children);
-        children.clear();
-        if(!object) return;
+        QObject *object = objectAtIndex(index);
+        QByteArray propertyName = propertyNameAtIndex(index);
+        if(!object || propertyName.isEmpty())
+            return false;
+        return metaPropertyAtIndex(index).isWritable() || object->dynamicPropertyNames().contains(propertyName);
+    }
+    
+    bool QtAbstractPropertyModel::setBatchData(const QModelIndexList &indexes, const QVariantList &values, QModelIndexList *failedIndexes)
+    {
+        if(indexes.size() != values.size())
+            return false;
+        QModelIndexList changedIndexes;
+        bool success = true;
+        // The whole batch is a single undo step.
+        bool isUndoMacro = _undoStack && !_isUndoing && indexes.size() > 1;
+        if(isUndoMacro)
+            _undoStack->beginMacro(QString("Edit ") + QString::number(indexes.size()) + QString(" Cells"));
+        for(int i = 0; i < indexes.size(); ++i) {
+            const QModelIndex &cell = indexes.at(i);
+            if(!setData(cell, values.at(i), Qt::EditRole)) {
+                success = false;
+                if(failedIndexes)
+                    failedIndexes->append(cell);
+                continue;
+            }
+            changedIndexes.append(cell);
+        }
+        if(isUndoMacro)
+            _undoStack->endMacro();
+        // Coalesced updates instead of one per cell.
+        emitDataChanged(changedIndexes);
+        return success;
+    }
+    
+    bool QtAbstractPropertyModel::setBatchData(const QModelIndexList &indexes, const QVariant &value, QModelIndexList *failedIndexes)
+    {
+        QVariantList values;
+        values.reserve(indexes.size());
+        for(int i = 0; i < indexes.size(); ++i)
+            values.append(value);
+        return setBatchData(indexes, values, failedIndexes);
+    }
+    
+    void QtAbstractPropertyModel::emitDataChanged(const QModelIndexList &indexes)
+    {
+        QHash<QPair<QModelIndex, int>, QVector<int> > rowsByColumn;
+        foreach(const QModelIndex &cell, indexes)
+            rowsByColumn[QPair<QModelIndex, int>(cell.parent(), cell.column())].append(cell.row());
+        for(auto it = rowsByColumn.begin(); it != rowsByColumn.end(); ++it) {
+            const QModelIndex &parent = it.key().first;
+            int column = it.key().second;
+            QVector<int> &rows = it.value();
+            std::sort(rows.begin(), rows.end());
+            int firstRow = rows.first();
+            for(int i = 1; i <= rows.size(); ++i) {
+                // Unselected rows in between are not reported as changed.
+                if(i < rows.size() && rows.at(i) <= rows.at(i - 1) + 1)
+                    continue;
+                emit dataChanged(index(firstRow, column, parent), index(rows.at(i - 1), column, parent));
+                if(i < rows.size())
+                    firstRow = rows.at(i);
+            }
+        }
+    }
+    
+    /* --------------------------------------------------------------------------------
+     * Undo commands for edits made via a QtAbstractPropertyModel.
+     * -------------------------------------------------------------------------------- */
+    
+    // Approximate heap size of a recorded value.
+    static qint64 variantBytes(const QVariant &value)
+    {
+        qint64 bytes = sizeof(QVariant);
+        switch(value.typeId()) {
+            case QMetaType::QString:
+                bytes += value.toString().size() * sizeof(QChar);
+                break;
+            case QMetaType::QByteArray:
+                bytes += value.toByteArray().size();
+                break;
+            case QMetaType::QStringList:
+            case QMetaType::QVariantList:
+                foreach(const QVariant &item, value.toList())
+                    bytes += variantBytes(item);
+                break;
+            default:
+                if(value.metaType().sizeOf() > 16)
+                    bytes += value.metaType().sizeOf();
+                break;
+        }
+        return bytes;
+    }
+    
+    class QtPropertyUndoCommand : public QUndoCommand
+    {
+    public:
+        QtPropertyUndoCommand(QtAbstractPropertyModel *model, const QString &text) : QUndoCommand(text), _model(model) {}
+        ~QtPropertyUndoCommand()
+        {
+            if(_model && _model->_undoCommands.removeOne(this))
+                _model->_undoBytes -= _bytes;
+        }
         
-        // Compiled properties (but exclude objectName as this is displayed for the object node itself).
-        const QMetaObject *metaObject = object->metaObject();
-        int numProperties = metaObject->propertyCount();
-        for(int i = 0; i < numProperties; ++i) {
-            const QMetaProperty metaProperty = metaObject->property(i);
-            QByteArray propertyName = QByteArray(metaProperty.name());
-            if(propertyNames.isEmpty() || propertyNames.contains(propertyName)) {
-                Node *node = new Node(this);
-                node->propertyName = propertyName;
-                children.append(node);
+        qint64 bytes() const { return _bytes; }
+        
+        // Called once the command falls outside of the model's history byte budget.
+        // Frees the recorded payload and turns the command into a no-op that the stack will discard.
+        virtual void release() { _isReleased = true; setObsolete(true); }
+        
+    protected:
+        QPointer<QtAbstractPropertyModel> _model;
+        qint64 _bytes = 0;
+        bool _isReleased = false;
+        
+        void setBytes(qint64 bytes)
+        {
+            if(_model && _model->_undoCommands.contains(this))
+                _model->_undoBytes += bytes - _bytes;
+            _bytes = bytes;
+        }
+    };
+    
+    // Property value change (object, property, old value, new value).
+    class QtPropertyValueCommand : public QtPropertyUndoCommand
+    {
+    public:
+        QtPropertyValueCommand(QtAbstractPropertyModel *model, const QModelIndex &index, QObject *object, const QByteArray &propertyName, const QVariant &oldValue, const QVariant &newValue) :
+        QtPropertyUndoCommand(model, QString("Edit ") + QString(propertyName)), _index(index), _object(object), _propertyName(propertyName), _oldValue(oldValue), _newValue(newValue)
+        {
+            _bytes = sizeof(*this) + _propertyName.size() + variantBytes(_oldValue) + variantBytes(_newValue);
+        }
+        
+        int id() const Q_DECL_OVERRIDE { return 0x51504556; }
+        
+        bool mergeWith(const QUndoCommand *other) Q_DECL_OVERRIDE
+        {
+            // Consecutive edits of the same cell are merged into a single step.
+            const QtPropertyValueCommand *command = static_cast<const QtPropertyValueCommand*>(other);
+            if(_isReleased || command->_object != _object || command->_propertyName != _propertyName)
+                return false;
+            _newValue = command->_newValue;
+            setBytes(sizeof(*this) + _propertyName.size() + variantBytes(_oldValue) + variantBytes(_newValue));
+            return true;
+        }
+        
+        void undo() Q_DECL_OVERRIDE { apply(_oldValue); }
+        void redo() Q_DECL_OVERRIDE
+        {
+            // The value has already been set when the command is first pushed.
+            if(_isFirstRedo)
+                _isFirstRedo = false;
+            else
+                apply(_newValue);
+        }
+        
+        void release() Q_DECL_OVERRIDE
+        {
+            _oldValue = _newValue = QVariant();
+            QtPropertyUndoCommand::release();
+        }
+        
+    protected:
+        QPersistentModelIndex _index;
+        QPointer<QObject> _object;
+        QByteArray _propertyName;
+        QVariant _oldValue;
+        QVariant _newValue;
+        bool _isFirstRedo = true;
+        
+        void apply(const QVariant &value)
+        {
+            if(_isReleased || !_object)
+                return;
+            // Go through the model if the cell is still there so that views and caches are updated.
+            QtAbstractPropertyModel *model = _model;
+            if(model && _index.isValid() && model->objectAtIndex(_index) == _object) {
+                model->_isUndoing = true;
+                model->setData(_index, value, Qt::EditRole);
+                model->_isUndoing = false;
+                emit model->dataChanged(_index, _index);
+            } else {
+                _object->setProperty(_propertyName.constData(), value);
             }
         }
-        // Dynamic properties.
-        QList<QByteArray> dynamicPropertyNames = object->dynamicPropertyNames();
-        foreach(const QByteArray &propertyName, dynamicPropertyNames) {
-            if(propertyNames.isEmpty() || propertyNames.contains(propertyName)) {
-                Node *node = new Node(this);
-                node->propertyName = propertyName;
-                children.append(node);
+    };
+    
+    // Insertion or removal of table rows.
+    // Objects that are not in the model are detached from their parents and owned by the command.
+    class QtPropertyRowsCommand : public QtPropertyUndoCommand
+    {
+    public:
+        QtPropertyRowsCommand(QtPropertyTableModel *model, int row, const QObjectList &objects, bool isInsertion) :
+        QtPropertyUndoCommand(model, isInsertion ? QString("Insert Rows") : QString("Delete Rows")), _tableModel(model), _row(row), _isInsertion(isInsertion)
+        {
+            foreach(QObject *object, objects) {
+                _objects.append(object);
+                _parents.append(object ? object->parent() : NULL);
             }
+            _bytes = sizeof(*this) + objects.size() * (sizeof(QPointer<QObject>) * 2 + sizeof(QObject));
         }
-        // Child objects.
-        if(maxChildDepth > 0 || maxChildDepth == -1) {
-            if(maxChildDepth > 0)
-                --maxChildDepth;
-            QMap<QByteArray, QObjectList> childMap;
-            foreach(QObject *child, object->children()) {
-                childMap[QByteArray(child->metaObject()->className())].append(child);
-            }
-            for(auto it = childMap.begin(); it != childMap.end(); ++it) {
-                foreach(QObject *child, it.value()) {
-                    Node *node = new Node(this);
-                    node->setObject(child, maxChildDepth, propertyNames);
-                    children.append(node);
+        
+        ~QtPropertyRowsCommand()
+        {
+            if(_ownsObjects) {
+                foreach(const QPointer<QObject> &object, _objects) {
+                    if(object)
+                        delete object.data();
                 }
             }
         }
-    }
+        
+        void undo() Q_DECL_OVERRIDE { if(_isInsertion) detach(); else attach(); }
+        void redo() Q_DECL_OVERRIDE { if(_isInsertion) attach(); else detach(); }
+        
+        void release() Q_DECL_OVERRIDE
+        {
+            if(_ownsObjects) {
+                foreach(const QPointer<QObject> &object, _objects) {
+                    if(object)
+                        delete object.data();
+                }
+            }
+            _ownsObjects = false;
+            _objects.clear();
+            _parents.clear();
+            QtPropertyUndoCommand::release();
+        }
+        
+    protected:
+        QPointer<QtPropertyTableModel> _tableModel;
+        int _row;
+        bool _isInsertion;
+        bool _ownsObjects = false;
+        QList<QPointer<QObject> > _objects;
+        QList<QPointer<QObject> > _parents;
+        
+        void attach()
+        {
+            if(_isReleased || !_tableModel)
+                return;
+            QObjectList objects;
+            for(int i = 0; i < _objects.size(); ++i) {
+                if(QObject *object = _objects.at(i)) {
+                    if(object->parent() != _parents.at(i))
+                        object->setParent(_parents.at(i));
+                    objects.append(object);
+                }
+            }
+            _ownsObjects = false;
+            _tableModel->insertObjects(qMin(_row, _tableModel->rowCount()), objects);
+        }
+        
+        void detach()
+        {
+            if(_isReleased || !_tableModel)
+                return;
+            QObjectList objects = _tableModel->takeObjects(_row, _objects.size());
+            _objects.clear();
+            _parents.clear();
+            foreach(QObject *object, objects) {
+                if(!object)
+                    continue; // Destroyed while in the model.
+                _objects.append(object);
+                _parents.append(object->parent());
+                object->setParent(NULL);
+            }
+            _ownsObjects = true;
+        }
+    };
     
-    QtPropertyTreeModel::Node* QtPropertyTreeModel::nodeAtIndex(const QModelIndex &index) const
+    // Reordering of table rows.
+    class QtPropertyMoveRowsCommand : public QtPropertyUndoCommand
     {
-        try {
-            return static_cast<Node*>(index.internalPointer());
-        } catch(...) {
-            return NULL;
+    public:
+        QtPropertyMoveRowsCommand(QtPropertyTableModel *model, int sourceRow, int count, int destinationRow) :
+        QtPropertyUndoCommand(model, QString("Move Rows")), _tableModel(model), _sourceRow(sourceRow), _count(count), _destinationRow(destinationRow)
+        {
+            _bytes = sizeof(*this);
         }
-    }
+        
+        void undo() Q_DECL_OVERRIDE
+        {
+            if(!_isReleased && _tableModel)
+                _tableModel->moveObjects(_movedToRow, _count, _sourceRow);
+        }
+        
+        void redo() Q_DECL_OVERRIDE
+        {
+            if(!_isReleased && _tableModel)
+                _movedToRow = _tableModel->moveObjects(_sourceRow, _count, _destinationRow);
+        }
+        
+    protected:
+        QPointer<QtPropertyTableModel> _tableModel;
+        int _sourceRow;
+        int _count;
+        int _destinationRow;
+        int _movedToRow = 0;
+    };
     
-    QObject* QtPropertyTreeModel::objectAtIndex(const QModelIndex &index) const
+    bool QtAbstractPropertyModel::writeProperty(const QModelIndex &index, QObject *object, const QByteArray &propertyName, const QVariant &value)
     {
-        // If node is an object, return the node's object.
-        // Else if node is a property, return the parent node's object.
-        Node *node = nodeAtIndex(index);
-        if(!node) return NULL;
-        if(node->object) return node->object;
-        if(node->parent) return node->parent->object;
-        return NULL;
+        bool isRecording = _undoStack && !_isUndoing;
+        QVariant oldValue;
+        if(isRecording)
+            oldValue = object->property(propertyName.constData());
+        bool result = object->setProperty(propertyName.constData(), value);
+        // Result will be FALSE for dynamic properties, which causes the tree view to lag.
+        // So make sure we still return TRUE in this case.
+        if(!result && object->dynamicPropertyNames().contains(propertyName))
+            result = true;
+        if(result && isRecording)
+            pushUndoCommand(new QtPropertyValueCommand(this, index, object, propertyName, oldValue, object->property(propertyName.constData())));
+        return result;
     }
     
-    QByteArray QtPropertyTreeModel::propertyNameAtIndex(const QModelIndex &index) const
+    void QtAbstractPropertyModel::pushUndoCommand(QtPropertyUndoCommand *command)
     {
-        // If node is a property, return the node's property name.
-        // Else if node is an object, return "objectName".
-        Node *node = nodeAtIndex(index);
-        if(!node) return QByteArray();
-        if(!node->propertyName.isEmpty()) return node->propertyName;
-        return QByteArray();
+        // The stack owns the command. If it is merged into the previous command it is deleted immediately
+        // and removes itself from the byte accounting.
+        _undoCommands.append(command);
+        _undoBytes += command->bytes();
+        _undoStack->push(command);
+        trimUndoHistory();
     }
     
-    QModelIndex QtPropertyTreeModel::index(int row, int column, const QModelIndex &parent) const
+    void QtAbstractPropertyModel::trimUndoHistory()
     {
-        // Return a model index whose internal pointer references the appropriate tree node.
-        if(column < 0 || column >= 2 || !hasIndex(row, column, parent))
-            return QModelIndex();
-        const Node *parentNode = parent.isValid() ? nodeAtIndex(parent) : &_root;
-        if(!parentNode || row < 0 || row >= parentNode->children.size())
-            return QModelIndex();
-        Node *node = parentNode->children.at(row);
-        return node ? createIndex(row, column, node) : QModelIndex();
+        while(_undoBytes > _undoByteBudget && _undoCommands.size() > 1) {
+            QtPropertyUndoCommand *command = _undoCommands.takeFirst();
+            _undoBytes -= command->bytes();
+            command->release();
+        }
     }
     
-    QModelIndex QtPropertyTreeModel::parent(const QModelIndex &index) const
+    void QtAbstractPropertyModel::forEachPropertyValueIndex(const std::function<void(const QModelIndex &index)> &func, const QModelIndex &parent) const
     {
-        // Return a model index for parent node (column must be 0).
-        if(!index.isValid())
-            return QModelIndex();
-        Node *node = nodeAtIndex(index);
-        if(!node)
-            return QModelIndex();
-        Node *parentNode = node->parent;
-        if(!parentNode || parentNode == &_root)
-            return QModelIndex();
-        int row = 0;
-        Node *grandparentNode = parentNode->parent;
-        if(grandparentNode)
-            row = grandparentNode->children.indexOf(parentNode);
-        return createIndex(row, 0, parentNode);
+        int numRows = rowCount(parent);
+        int numColumns = columnCount(parent);
+        for(int row = 0; row < numRows; ++row) {
+            for(int column = 0; column < numColumns; ++column) {
+                QModelIndex cell = index(row, column, parent);
+                if(isPropertyValueIndex(cell))
+                    func(cell);
+            }
+            QModelIndex child = index(row, 0, parent);
+            if(hasChildren(child))
+                forEachPropertyValueIndex(func, child);
+        }
     }
     
-    int QtPropertyTreeModel::rowCount(const QModelIndex &parent) const
+    void QtAbstractPropertyModel::captureBaseline(const QtAbstractPropertyModel *model)
     {
-        // Return number of child nodes.
-        const Node *parentNode = parent.isValid() ? nodeAtIndex(parent) : &_root;
-        return parentNode ? parentNode->children.size() : 0;
+        _baseline.clear();
+        _changedCells.clear();
+        if(model) {
+            model->forEachPropertyValueIndex([&](const QModelIndex &index) {
+                _baseline.insert(model->propertyPathAtIndex(index), valueHash(model->data(index, Qt::EditRole)));
+            });
+        }
+        _hasBaseline = (model != NULL);
+        baselineChanged();
     }
     
-    int QtPropertyTreeModel::columnCount(const QModelIndex &parent) const
+    void QtAbstractPropertyModel::clearBaseline()
     {
-        // Return 2 for name/value columns.
-        const Node *parentNode = parent.isValid() ? nodeAtIndex(parent) : &_root;
-        return (parentNode ? 2 : 0);
+        _baseline.clear();
+        _changedCells.clear();
+        _hasBaseline = false;
+        baselineChanged();
     }
     
-    QVariant QtPropertyTreeModel::data(const QModelIndex &index, int role) const
+    bool QtAbstractPropertyModel::isChangedFromBaseline(const QModelIndex &index) const
     {
-        if(!index.isValid())
-            return QVariant();
-        if(role == Qt::DisplayRole || role == Qt::EditRole) {
-            QObject *object = objectAtIndex(index);
-            if(!object)
-                return QVariant();
-            QByteArray propertyName = propertyNameAtIndex(index);
-            if(index.column() == 0) {
-                // Object's class name or else the property name.
-                if(propertyName.isEmpty())
-                    return QVariant(object->metaObject()->className());
-                else if(propertyHeaders.contains(propertyName))
-                    return QVariant(propertyHeaders[propertyName]);
-                else
-                    return QVariant(propertyName);
-            } else if(index.column() == 1) {
-                // Object's objectName or else the property value.
-                if(propertyName.isEmpty())
-                    return QVariant(object->objectName());
-                else
-                    return object->property(propertyName.constData());
-            }
+        // Cells missing from the baseline count as changed.
+        if(!_hasBaseline || !index.isValid())
+            return false;
+        CellKey key = { index.internalId(), index.row(), index.column() };
+        auto cached = _changedCells.constFind(key);
+        if(cached != _changedCells.constEnd())
+            return cached.value();
+        bool isChanged = false;
+        if(isPropertyValueIndex(index)) {
+            auto it = _baseline.constFind(propertyPathAtIndex(index));
+            isChanged = (it == _baseline.constEnd() || it.value() != valueHash(data(index, Qt::EditRole)));
         }
-        return QVariant();
+        _changedCells.insert(key, isChanged);
+        return isChanged;
     }
     
-    bool QtPropertyTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
+    void QtAbstractPropertyModel::invalidateChangedCells(const QModelIndex &topLeft, const QModelIndex &bottomRight)
     {
-        if(!index.isValid())
+        if(_changedCells.isEmpty() || !topLeft.isValid() || !bottomRight.isValid())
+            return;
+        qint64 numCells = qint64(bottomRight.row() - topLeft.row() + 1) * (bottomRight.column() - topLeft.column() + 1);
+        if(numCells >= _changedCells.size()) {
+            // Cheaper to re-evaluate everything than to look up each cell in the range.
+            _changedCells.clear();
+            return;
+        }
+        QModelIndex parent = topLeft.parent();
+        for(int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+            for(int column = topLeft.column(); column <= bottomRight.column(); ++column) {
+                QModelIndex cell = index(row, column, parent);
+                CellKey key = { cell.internalId(), row, column };
+                _changedCells.remove(key);
+            }
+        }
+    }
+    
+    void QtAbstractPropertyModel::baselineChanged()
+    {
+        if(rowCount() && columnCount())
+            emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1), QList<int>() << ValueChangedRole << Qt::BackgroundRole);
+    }
+    
+    static const quint32 SnapshotMagic = 0x51504553; // "QPES"
+    static const quint32 SnapshotVersion = 1;
+    
+    bool QtAbstractPropertyModel::saveSnapshot(QIODevice *device, SnapshotFormat format) const
+    {
+        if(!device || !device->isWritable())
             return false;
-        if(role == Qt::EditRole) {
-            QObject *object = objectAtIndex(index);
-            if(!object)
-                return false;
-            QByteArray propertyName = propertyNameAtIndex(index);
-            if(index.column() == 0) {
-                // Object class name or property name.
-                return false;
-            } else if(index.column() == 1) {
-                // Object's objectName or else the property value.
-                if(propertyName.isEmpty()) {
-                    object->setObjectName(value.toString());
-                    return true;
+        if(format == BinarySnapshot) {
+            // Header followed by (path, value) records terminated by an empty path.
+            QDataStream out(device);
+            out.setVersion(QDataStream::Qt_6_0);
+            out << SnapshotMagic << SnapshotVersion;
+            forEachPropertyValueIndex([&](const QModelIndex &index) {
+                if(!isWritableIndex(index))
+                    return;
+                QVariant value = data(index, Qt::EditRole);
+                const QMetaProperty metaProperty = metaPropertyAtIndex(index);
+                if(metaProperty.isValid() && metaProperty.isEnumType())
+                    value = QVariant(valueToText(value, metaProperty));
+                else if(!value.isValid() || !value.metaType().hasRegisteredDataStreamOperators())
+                    return;
+                out << propertyPathAtIndex(index) << value;
+            });
+            out << QString();
+            return out.status() == QDataStream::Ok;
+        } else if(format == JsonSnapshot) {
+            QJsonObject values;
+            forEachPropertyValueIndex([&](const QModelIndex &index) {
+                if(!isWritableIndex(index))
+                    return;
+                QVariant value = data(index, Qt::EditRole);
+                const QMetaProperty metaProperty = metaPropertyAtIndex(index);
+                // Numbers and bools are stored as JSON values, everything else as text.
+                // 64-bit integers are also stored as text, as JSON numbers are doubles (exact only up to 2^53).
+                int typeId = value.typeId();
+                bool isWideInteger = (typeId == QMetaType::LongLong || typeId == QMetaType::ULongLong || typeId == QMetaType::Long || typeId == QMetaType::ULong);
+                if(typeId == QMetaType::Bool)
+                    values.insert(propertyPathAtIndex(index), value.toBool());
+                else if(isNumericTypeId(typeId) && !isWideInteger && !(metaProperty.isValid() && metaProperty.isEnumType()))
+                    values.insert(propertyPathAtIndex(index), value.toDouble());
+                else if(value.isValid())
+                    values.insert(propertyPathAtIndex(index), valueToText(value, metaProperty));
+            });
+            QJsonObject snapshot;
+            snapshot.insert("format", QString("QtPropertyEditor"));
+            snapshot.insert("version", int(SnapshotVersion));
+            snapshot.insert("values", values);
+            return device->write(QJsonDocument(snapshot).toJson()) != -1;
+        }
+        return false;
+    }
+    
+    bool QtAbstractPropertyModel::restoreSnapshot(QIODevice *device, SnapshotFormat format)
+    {
+        if(!device || !device->isReadable())
+            return false;
+        // Map paths to cells with a single walk of the model.
+        QHash<QString, QPersistentModelIndex> cells;
+        forEachPropertyValueIndex([&](const QModelIndex &index) {
+            if(isWritableIndex(index))
+                cells.insert(propertyPathAtIndex(index), index);
+        });
+        // Values are set without per-cell notifications and the views are updated once per run of restored cells at the end.
+        QModelIndexList restoredIndexes;
+        bool isUndoMacro = _undoStack && !_isUndoing;
+        if(isUndoMacro)
+            _undoStack->beginMacro("Restore Snapshot");
+        auto restoreValue = [&](const QString &path, const QVariant &value) {
+            auto it = cells.constFind(path);
+            if(it == cells.constEnd() || !it.value().isValid())
+                return;
+            QModelIndex index = it.value();
+            QVariant restoredValue = value;
+            if(value.typeId() == QMetaType::QString) {
+                // Text values (e.g. enum keys and 64-bit integers) are parsed according to the current value type.
+                bool ok;
+                restoredValue = valueFromText(value.toString(), data(index, Qt::EditRole).typeId(), metaPropertyAtIndex(index), &ok);
+                if(!ok)
+                    return;
+            }
+            if(setData(index, restoredValue, Qt::EditRole))
+                restoredIndexes.append(index);
+        };
+        bool success = false;
+        if(format == BinarySnapshot) {
+            QDataStream in(device);
+            in.setVersion(QDataStream::Qt_6_0);
+            quint32 magic, version;
+            in >> magic >> version;
+            if(magic == SnapshotMagic && version <= SnapshotVersion) {
+                forever {
+                    QString path;
+                    QVariant value;
+                    in >> path;
+                    if(path.isEmpty() || in.status() != QDataStream::Ok)
+                        break;
+                    in >> value;
+                    if(in.status() != QDataStream::Ok)
+                        break;
+                    restoreValue(path, value);
+                }
+                success = (in.status() == QDataStream::Ok);
+            }
+        } else if(format == JsonSnapshot) {
+            QJsonDocument doc = QJsonDocument::fromJson(device->readAll());
+            QJsonObject values = doc.object().value("values").toObject();
+            for(auto it = values.constBegin(); it != values.constEnd(); ++it)
+                restoreValue(it.key(), it.value().toVariant());
+            success = doc.isObject();
+        }
+        if(isUndoMacro)
+            _undoStack->endMacro();
+        // Covers nested cells (e.g. child objects in the tree), not just the top-level rows.
+        emitDataChanged(restoredIndexes);
+        return success;
+    }
+    
+    void QtPropertyTreeModel::Node::clearChildren()
+    {
+        qDeleteAll(children);
+        children.clear();
+        qDeleteAll(propertyNodes);
+        propertyNodes.clear();
+        properties.reset();
+    }
+    
+    QObjectList QtPropertyTreeModel::orderedChildObjects(const QObject *object, ChildOrder order, const ChildLessThanFunction &lessThan)
+    {
+        // Stable sorts, so objects that compare equal stay in creation order.
+        QObjectList children = object->children();
+        if(order == ClassGroupedOrder) {
+            std::stable_sort(children.begin(), children.end(), [](const QObject *a, const QObject *b) {
+                return a->metaObject() != b->metaObject() && qstrcmp(a->metaObject()->className(), b->metaObject()->className()) < 0;
+            });
+        } else if(order == ObjectNameOrder) {
+            std::stable_sort(children.begin(), children.end(), [](const QObject *a, const QObject *b) {
+                return a->objectName().compare(b->objectName(), Qt::CaseInsensitive) < 0;
+            });
+        } else if(order == CustomOrder && lessThan) {
+            std::stable_sort(children.begin(), children.end(), lessThan);
+        }
+        return children;
+    }
+    
+    QString QtPropertyTreeModel::Node::pathSegment() const
+    {
+        // Sibling objects are those below the same object (class groups are not part of the path).
+        const Node *parentNode = (parent && parent->groupClass) ? parent->parent : parent;
+        QString name = object->objectName();
+        QString segment = name.isEmpty() ? QString(object->metaObject()->className()) : name;
+        int siblingIndex = 0;
+        int numSiblings = 0;
+        auto countSibling = [&](const Node *sibling) {
+            if(!sibling->object || sibling->object->metaObject() != object->metaObject() || sibling->object->objectName() != name)
+                return;
+            if(sibling == this)
+                siblingIndex = numSiblings;
+            ++numSiblings;
+        };
+        if(parentNode) {
+            foreach(const Node *child, parentNode->children) {
+                if(child->groupClass) {
+                    foreach(const Node *groupedChild, child->children)
+                        countSibling(groupedChild);
                 } else {
-                    bool result = object->setProperty(propertyName.constData(), value);
-                    // Result will be FALSE for dynamic properties, which causes the tree view to lag.
-                    // So make sure we still return TRUE in this case.
-                    if(!result && object->dynamicPropertyNames().contains(propertyName))
-                        return true;
-                    return result;
+                    countSibling(child);
                 }
             }
         }
-        return false;
+        // Unnamed objects, and objects that share their name and class with a sibling, are numbered in tree order.
+        if(name.isEmpty() || numSiblings > 1)
+            segment += QString("[") + QString::number(siblingIndex) + QString("]");
+        return segment;
     }
     
-    Qt::ItemFlags QtPropertyTreeModel::flags(const QModelIndex &index) const
+    QString QtPropertyTreeModel::Node::path() const
     {
-        Qt::ItemFlags flags = QAbstractItemModel::flags(index);
-        if(!index.isValid())
-            return flags;
-        QObject *object = objectAtIndex(index);
-        if(!object)
-            return flags;
-        flags |= Qt::ItemIsEnabled;
-        flags |= Qt::ItemIsSelectable;
-        if(index.column() == 1) {
-            QByteArray propertyName = propertyNameAtIndex(index);
-            const QMetaProperty metaProperty = metaPropertyAtIndex(index);
-            if(metaProperty.isWritable() || object->dynamicPropertyNames().contains(propertyName) || objectAtIndex(index))
-                flags |= Qt::ItemIsEditable;
+        QString path = QString::fromUtf8(propertyName);
+        for(const Node *node = propertyName.isEmpty() ? this : parent; node && node->parent; node = node->parent) {
+            if(!node->object) {
+                // Gadget fields and container elements are prefixed by the property they belong to.
+                if(!node->propertyName.isEmpty())
+                    path = QString::fromUtf8(node->propertyName) + (path.startsWith(QChar('[')) ? QString() : QString(".")) + path;
+                continue;
+            }
+            QString segment = node->pathSegment();
+            path = path.isEmpty() ? segment : segment + QString(".") + path;
         }
-        return flags;
+        return path;
     }
     
-    QVariant QtPropertyTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+    QtPropertyTreeModel::QtPropertyTreeModel(QObject *parent) : QtAbstractPropertyModel(parent)
     {
-        if(role == Qt::DisplayRole) {
-            if(orientation == Qt::Horizontal) {
-                if(section == 0)
-                    return QVariant("Name");
-                else if(section == 1)
-                    return QVariant("Value");
+        _childSyncTimer.setSingleShot(true);
+        _childSyncTimer.setInterval(0);
+        connect(&_childSyncTimer, SIGNAL(timeout()), this, SLOT(syncPendingChildObjects()));
+        _elementWriteTimer.setSingleShot(true);
+        _elementWriteTimer.setInterval(0);
+        connect(&_elementWriteTimer, SIGNAL(timeout()), this, SLOT(writePendingElements()));
+        connect(this, SIGNAL(dataChanged(QModelIndex, QModelIndex, QList<int>)), this, SLOT(updateMixedValues(QModelIndex, QModelIndex)));
+        connect(this, SIGNAL(dataChanged(QModelIndex, QModelIndex, QList<int>)), this, SLOT(refreshReferenceNodes(QModelIndex, QModelIndex)));
+        connect(this, SIGNAL(rowsAboutToBeRemoved(QModelIndex, int, int)), this, SLOT(valueStoreRowsAboutToBeRemoved(QModelIndex, int, int)));
+    }
+    
+    QSharedPointer<const QtPropertyTreeModel::PropertyTemplate> QtPropertyTreeModel::propertyTemplate(const Node *objectNode, const Node::PropertyFilter &filter)
+    {
+        QObject *object = objectNode->object;
+        const QMetaObject *metaObject = object->metaObject();
+        QList<QByteArray> dynamicPropertyNames = object->dynamicPropertyNames();
+        // Entries only live as long as a node uses them, and that node's object keeps the meta object alive,
+        // so a dynamic meta object that is later allocated at the same address is never matched.
+        bool isShared = !filter && dynamicPropertyNames.isEmpty();
+        if(isShared) {
+            QSharedPointer<const PropertyTemplate> properties = _propertyTemplates.value(metaObject).toStrongRef();
+            if(properties)
+                return properties;
+        }
+        QSharedPointer<PropertyTemplate> properties(new PropertyTemplate);
+        int numProperties = metaObject->propertyCount();
+        for(int i = 0; i < numProperties; ++i) {
+            const QMetaProperty metaProperty = metaObject->property(i);
+            QByteArray propertyName(metaProperty.name());
+            if((propertyNames.isEmpty() || propertyNames.contains(propertyName)) && (!filter || filter(objectNode, propertyName))) {
+                properties->names.append(propertyName);
+                properties->types.append(metaProperty.metaType());
             }
         }
-        return QVariant();
+        foreach(const QByteArray &propertyName, dynamicPropertyNames) {
+            if((propertyNames.isEmpty() || propertyNames.contains(propertyName)) && (!filter || filter(objectNode, propertyName))) {
+                properties->names.append(propertyName);
+                properties->types.append(QMetaType());
+            }
+        }
+        if(isShared)
+            _propertyTemplates.insert(metaObject, properties);
+        return properties;
     }
     
-    QObject* QtPropertyTableModel::objectAtIndex(const QModelIndex &index) const
+    void QtPropertyTreeModel::setNodeObject(Node *node, QObject *object, int maxChildDepth, const Node::PropertyFilter &filter)
     {
-        if(_objects.size() <= index.row())
-            return 0;
-        QObject *object = _objects.at(index.row());
-        // If property names are specified, check if name at column is a path to a child object property.
-        if(!propertyNames.isEmpty()) {
-            if(propertyNames.size() > index.column()) {
-                QByteArray propertyName = propertyNames.at(index.column());
-                if(propertyName.contains('.')) {
-                    int pos = propertyName.lastIndexOf('.');
-                    return descendant(object, propertyName.left(pos));
+        node->clearChildren();
+        node->object = object;
+        node->propertyName.clear();
+        if(!object) return;
+        
+        // Property rows.
+        node->properties = propertyTemplate(node, filter);
+        
+        // Child objects.
+        if(maxChildDepth > 0 || maxChildDepth == -1) {
+            if(maxChildDepth > 0)
+                --maxChildDepth;
+            QHash<const QMetaObject*, Node*> groupNodes;
+            foreach(QObject *child, orderedChildObjects(object, _childOrder, _childLessThan)) {
+                Node *childNode = new Node(node);
+                setNodeObject(childNode, child, maxChildDepth, filter);
+                if(filter && !childNode->numPropertyRows() && childNode->children.isEmpty()) {
+                    delete childNode;
+                    continue;
+                }
+                if(_showClassGroups) {
+                    Node *&groupNode = groupNodes[child->metaObject()];
+                    if(!groupNode) {
+                        groupNode = new Node(node);
+                        groupNode->groupClass = child->metaObject();
+                        node->children.append(groupNode);
+                    }
+                    childNode->parent = groupNode;
+                    groupNode->children.append(childNode);
+                } else {
+                    node->children.append(childNode);
                 }
             }
+            // Class groups are ordered by class name (see classGroupRow()), their objects by the child order.
+            if(_showClassGroups) {
+                std::stable_sort(node->children.begin(), node->children.end(), [](const Node *a, const Node *b) {
+                    return qstrcmp(a->groupClass->className(), b->groupClass->className()) < 0;
+                });
+            }
         }
-        return object;
     }
     
-    QByteArray QtPropertyTableModel::propertyNameAtIndex(const QModelIndex &index) const
+    int QtPropertyTreeModel::classGroupRow(const Node *node, const QMetaObject *groupClass)
     {
-        // If property names are specified, return the name at column.
-        if(!propertyNames.isEmpty()) {
-            if(propertyNames.size() > index.column()) {
-                QByteArray propertyName = propertyNames.at(index.column());
-                if(propertyName.contains('.')) {
-                    int pos = propertyName.lastIndexOf('.');
-                    return propertyName.mid(pos + 1);
+        // Position among the class groups sorted by class name (after any groups of the same name).
+        int position = 0;
+        while(position < node->children.size() && qstrcmp(node->children.at(position)->groupClass->className(), groupClass->className()) <= 0)
+            ++position;
+        return position;
+    }
+    
+    void QtPropertyTreeModel::setRootObjects(const QObjectList &objects)
+    {
+        writePendingElements();
+        beginResetModel();
+        untrackObjects();
+        _objects = objects;
+        _objects.removeAll(NULL);
+        _hasMultipleRoots = true;
+        _mixedValues.clear();
+        Node::PropertyFilter filter = propertyFilter();
+        setNodeObject(&_root, NULL);
+        _propertyTemplates.clear();
+        foreach(QObject *object, _objects) {
+            Node *node = new Node(&_root);
+            setNodeObject(node, object, _maxTreeDepth, filter);
+            if(filter && !node->numPropertyRows() && node->children.isEmpty()) {
+                delete node;
+                continue;
+            }
+            _root.children.append(node);
+        }
+        foreach(QObject *object, _objects)
+            connect(object, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)), Qt::UniqueConnection);
+        foreach(Node *node, _root.children)
+            trackObjectNode(node);
+        endResetModel();
+    }
+    
+    void QtPropertyTreeModel::setObjects(const QObjectList &objects)
+    {
+        writePendingElements();
+        beginResetModel();
+        untrackObjects();
+        _objects = objects;
+        _objects.removeAll(NULL);
+        _hasMultipleRoots = false;
+        Node::PropertyFilter filter = propertyFilter();
+        setNodeObject(&_root, NULL);
+        _propertyTemplates.clear();
+        if(_objects.size() > 1) {
+            // Properties common to all objects. Compiled properties are intersected once per distinct class,
+            // whereas dynamic properties have to be checked per object.
+            QSet<QByteArray> commonPropertyNames;
+            QSet<const QMetaObject*> metaObjects;
+            bool isFirst = true;
+            foreach(QObject *object, _objects) {
+                const QMetaObject *metaObject = object->metaObject();
+                QSet<QByteArray> names;
+                if(!metaObjects.contains(metaObject)) {
+                    for(int i = 0; i < metaObject->propertyCount(); ++i)
+                        names.insert(QByteArray(metaObject->property(i).name()));
+                    metaObjects.insert(metaObject);
+                } else {
+                    // Same compiled properties as an object we have already seen.
+                    for(int i = 0; i < metaObject->propertyCount(); ++i) {
+                        QByteArray name(metaObject->property(i).name());
+                        if(commonPropertyNames.contains(name))
+                            names.insert(name);
+                    }
                 }
-                return propertyName;
+                foreach(const QByteArray &name, object->dynamicPropertyNames())
+                    names.insert(name);
+                if(isFirst)
+                    commonPropertyNames = names;
+                else
+                    commonPropertyNames.intersect(names);
+                isFirst = false;
             }
-            return QByteArray();
+            Node::PropertyFilter mergedFilter = [commonPropertyNames, filter](const Node *objectNode, const QByteArray &propertyName) {
+                return commonPropertyNames.contains(propertyName) && (!filter || filter(objectNode, propertyName));
+            };
+            // Child objects are not merged.
+            setNodeObject(&_root, _objects.first(), 0, mergedFilter);
+        } else {
+            setNodeObject(&_root, _objects.isEmpty() ? NULL : _objects.first(), _maxTreeDepth, filter);
         }
-        // If property names are NOT specified, return the metaObject's property name at column.
-        QObject *object = objectAtIndex(index);
-        if(!object)
-            return QByteArray();
-        const QMetaObject *metaObject = object->metaObject();
-        int numProperties = metaObject->propertyCount();
-        if(numProperties > index.column())
-            return QByteArray(metaObject->property(index.column()).name());
-        // If column is greater than the number of metaObject properties, check for dynamic properties.
-        const QList<QByteArray> &dynamicPropertyNames = object->dynamicPropertyNames();
-        if(numProperties + dynamicPropertyNames.size() > index.column())
-            return dynamicPropertyNames.at(index.column() - numProperties);
-        return QByteArray();
+        _mixedValues = QBitArray(isMerged() ? _root.numPropertyRows() : 0);
+        updateMixedValues(0, _mixedValues.size() - 1);
+        foreach(QObject *object, _objects)
+            connect(object, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)), Qt::UniqueConnection);
+        if(_root.object)
+            trackObjectNode(&_root);
+        endResetModel();
     }
     
-    QModelIndex QtPropertyTableModel::index(int row, int column, const QModelIndex &/* parent */) const
+    QModelIndex QtPropertyTreeModel::indexOfNode(const Node *node) const
     {
-        return createIndex(row, column);
+        if(!node || node == &_root || !node->parent)
+            return QModelIndex();
+        if(node->propertyRow >= 0)
+            return propertyRowIndex(node->parent, node->propertyRow, 0);
+        int row = node->parent->children.indexOf(const_cast<Node*>(node));
+        return row >= 0 ? createIndex(node->parent->numPropertyRows() + row, 0, const_cast<Node*>(node)) : QModelIndex();
     }
     
-    QModelIndex QtPropertyTableModel::parent(const QModelIndex &/* index */) const
+    void QtPropertyTreeModel::trackObjectNode(Node *node)
     {
-        return QModelIndex();
+        // Object nodes, including referenced objects below expanded values.
+        if(node->object) {
+            if(!_objectNodes.contains(node->object)) {
+                node->object->installEventFilter(this);
+                connect(node->object, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)), Qt::UniqueConnection);
+            }
+            _objectNodes.insert(node->object, node);
+        }
+        foreach(Node *child, node->children)
+            trackObjectNode(child);
+        foreach(Node *propertyNode, node->propertyNodes)
+            trackObjectNode(propertyNode);
     }
     
-    int QtPropertyTableModel::rowCount(const QModelIndex &/* parent */) const
+    void QtPropertyTreeModel::untrackObjectNode(Node *node)
     {
-        return _objects.size();
+        if(node->object) {
+            _objectNodes.remove(node->object, node);
+            if(!_objectNodes.contains(node->object)) {
+                node->object->removeEventFilter(this);
+                if(!_objects.contains(node->object))
+                    disconnect(node->object, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)));
+            }
+        }
+        foreach(Node *child, node->children)
+            untrackObjectNode(child);
+        foreach(Node *propertyNode, node->propertyNodes)
+            untrackObjectNode(propertyNode);
     }
     
-    int QtPropertyTableModel::columnCount(const QModelIndex &/* parent */) const
+    void QtPropertyTreeModel::untrackObjects()
     {
-        // Number of properties.
-        if(!propertyNames.isEmpty())
-            return propertyNames.size();
-        if(_objects.isEmpty())
-            return 0;
-        QObject *object = _objects.at(0);
-        const QMetaObject *metaObject = object->metaObject();
-        return metaObject->propertyCount() + object->dynamicPropertyNames().size();
+        for(auto it = _objectNodes.constBegin(); it != _objectNodes.constEnd(); ++it) {
+            it.key()->removeEventFilter(this);
+            disconnect(it.key(), SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)));
+        }
+        foreach(QObject *object, _objects)
+            disconnect(object, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)));
+        _objectNodes.clear();
+        _pendingChildSyncs.clear();
     }
     
-    QVariant QtPropertyTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+    void QtPropertyTreeModel::removeObjectNode(Node *node)
     {
-        if(role == Qt::DisplayRole) {
-            if(orientation == Qt::Vertical) {
-                return QVariant(section);
-            } else if(orientation == Qt::Horizontal) {
-                QByteArray propertyName = propertyNameAtIndex(createIndex(0, section));
-                QByteArray childPath;
-                if(propertyNames.size() > section) {
-                    QByteArray pathToPropertyName = propertyNames.at(section);
-                    if(pathToPropertyName.contains('.')) {
-                        int pos = pathToPropertyName.lastIndexOf('.');
-                        childPath = pathToPropertyName.left(pos + 1);
+        Node *parentNode = node->parent;
+        int position = parentNode ? parentNode->children.indexOf(node) : -1;
+        if(position < 0) {
+            // Not a child row (e.g. already detached), but its objects are no longer shown either.
+            untrackObjectNode(node);
+            return;
+        }
+        int row = parentNode->numPropertyRows() + position;
+        beginRemoveRows(indexOfNode(parentNode), row, row);
+        untrackObjectNode(node);
+        parentNode->children.removeAt(position);
+        delete node;
+        endRemoveRows();
+        // Class groups only exist while they have objects.
+        if(parentNode->groupClass && parentNode->children.isEmpty())
+            removeObjectNode(parentNode);
+    }
+    
+    QtPropertyTreeModel::Node* QtPropertyTreeModel::childObjectNode(Node *node, QObject *child) const
+    {
+        foreach(Node *childNode, node->children) {
+            if(childNode->object == child)
+                return childNode;
+            if(childNode->groupClass == child->metaObject()) {
+                foreach(Node *groupedNode, childNode->children) {
+                    if(groupedNode->object == child)
+                        return groupedNode;
+                }
+            }
+        }
+        return NULL;
+    }
+    
+    void QtPropertyTreeModel::objectDestroyed(QObject *object)
+    {
+        // Only the QObject part of object is left, so it is only used as a key.
+        if(!_hasMultipleRoots && _objects.contains(object)) {
+            // The root (or one of the merged objects) determines the whole tree.
+            _objects.removeAll(object);
+            reset();
+            return;
+        }
+        _objects.removeAll(object);
+        // Removing a node also removes its descendants, which may include other nodes of the object.
+        foreach(Node *node, _objectNodes.values(object)) {
+            if(_objectNodes.contains(object, node))
+                removeObjectNode(node);
+        }
+    }
+    
+    bool QtPropertyTreeModel::eventFilter(QObject *watched, QEvent *event)
+    {
+        if(event->type() == QEvent::ChildAdded) {
+            // The child may still be under construction, so it is added once control returns to the event loop.
+            if(!_pendingChildSyncs.contains(watched))
+                _pendingChildSyncs.append(watched);
+            _childSyncTimer.start();
+        } else if(event->type() == QEvent::ChildRemoved) {
+            QObject *child = static_cast<QChildEvent*>(event)->child();
+            foreach(Node *node, _objectNodes.values(watched)) {
+                if(Node *childNode = childObjectNode(node, child))
+                    removeObjectNode(childNode);
+            }
+        }
+        return QtAbstractPropertyModel::eventFilter(watched, event);
+    }
+    
+    void QtPropertyTreeModel::syncPendingChildObjects()
+    {
+        QList<QPointer<QObject> > pendingChildSyncs;
+        pendingChildSyncs.swap(_pendingChildSyncs);
+        foreach(const QPointer<QObject> &object, pendingChildSyncs) {
+            if(!object)
+                continue;
+            foreach(Node *node, _objectNodes.values(object))
+                syncChildObjects(node);
+        }
+    }
+    
+    void QtPropertyTreeModel::syncChildObjects(Node *node)
+    {
+        // Child objects of merged objects and referenced objects are not shown.
+        if(isMerged() || !node->object || (node->parent && node->parent->isReference))
+            return;
+        int depth = 0;
+        for(const Node *ancestor = node->parent; ancestor; ancestor = ancestor->parent) {
+            if(ancestor->object)
+                ++depth;
+        }
+        if(_maxTreeDepth != -1 && depth >= _maxTreeDepth)
+            return;
+        int maxChildDepth = (_maxTreeDepth == -1) ? -1 : _maxTreeDepth - depth - 1;
+        // Same order as setNodeObject() (after the property rows, or within each class group).
+        QHash<Node*, int> nextPositions; // Insertion position within the children of each parent node.
+        Node::PropertyFilter filter = propertyFilter();
+        foreach(QObject *child, orderedChildObjects(node->object, _childOrder, _childLessThan)) {
+            Node *parentNode = node;
+            if(_showClassGroups) {
+                parentNode = NULL;
+                foreach(Node *groupNode, node->children) {
+                    if(groupNode->groupClass == child->metaObject()) {
+                        parentNode = groupNode;
+                        break;
+                    }
+                }
+            }
+            if(Node *childNode = childObjectNode(node, child)) {
+                nextPositions.insert(childNode->parent, childNode->parent->children.indexOf(childNode) + 1);
+                continue;
+            }
+            Node *childNode = new Node(parentNode ? parentNode : node);
+            setNodeObject(childNode, child, maxChildDepth, filter);
+            if(filter && !childNode->numPropertyRows() && childNode->children.isEmpty()) {
+                delete childNode;
+                continue;
+            }
+            if(!parentNode) {
+                // New class group at its class name position.
+                parentNode = new Node(node);
+                parentNode->groupClass = child->metaObject();
+                int position = classGroupRow(node, parentNode->groupClass);
+                int groupRow = node->numPropertyRows() + position;
+                beginInsertRows(indexOfNode(node), groupRow, groupRow);
+                node->children.insert(position, parentNode);
+                endInsertRows();
+                childNode->parent = parentNode;
+            }
+            int position = nextPositions.value(parentNode, 0);
+            int row = parentNode->numPropertyRows() + position;
+            beginInsertRows(indexOfNode(parentNode), row, row);
+            parentNode->children.insert(position, childNode);
+            endInsertRows();
+            trackObjectNode(childNode);
+            nextPositions.insert(parentNode, position + 1);
+        }
+    }
+    
+    // Meta object of Q_GADGET value types (NULL for other types).
+    static const QMetaObject* gadgetMetaObject(QMetaType metaType)
+    {
+        static QHash<int, const QMetaObject*> metaObjects;
+        auto it = metaObjects.constFind(metaType.id());
+        if(it != metaObjects.constEnd())
+            return it.value();
+        const QMetaObject *metaObject = (metaType.flags() & QMetaType::IsGadget) ? metaType.metaObject() : NULL;
+        return metaObjects.insert(metaType.id(), metaObject).value();
+    }
+    
+    // Sequential containers other than strings (which are shown as a single value).
+    static bool isContainerType(QMetaType metaType)
+    {
+        static QHash<int, bool> isContainer;
+        auto it = isContainer.constFind(metaType.id());
+        if(it != isContainer.constEnd())
+            return it.value();
+        bool result = metaType != QMetaType::fromType<QString>() && metaType != QMetaType::fromType<QByteArray>()
+                && QMetaType::canView(metaType, QMetaType::fromType<QSequentialIterable>());
+        return isContainer.insert(metaType.id(), result).value();
+    }
+    
+    QtPropertyTreeModel::ValueKind QtPropertyTreeModel::valueKind(QMetaType metaType) const
+    {
+        if(!metaType.isValid())
+            return PlainValue;
+        if(_expandReferences && (metaType.flags() & QMetaType::PointerToQObject))
+            return ReferenceValue;
+        if(_expandContainers && isContainerType(metaType))
+            return ContainerValue;
+        if(_expandGadgets && gadgetMetaObject(metaType))
+            return GadgetValue;
+        return PlainValue;
+    }
+    
+    QMetaType QtPropertyTreeModel::propertyType(const Node *objectNode, int row) const
+    {
+        // Declared type, or else the type of a dynamic property's current value.
+        QMetaType metaType = objectNode->properties->types.at(row);
+        return metaType.isValid() ? metaType : objectNode->object->property(objectNode->properties->names.at(row).constData()).metaType();
+    }
+    
+    QtPropertyTreeModel::Node* QtPropertyTreeModel::propertyNode(Node *objectNode, int row)
+    {
+        Node *&node = objectNode->propertyNodes[row];
+        if(!node) {
+            node = new Node(objectNode);
+            node->propertyName = objectNode->properties->names.at(row);
+            node->propertyRow = row;
+            ValueKind kind = valueKind(propertyType(objectNode, row));
+            node->isContainer = (kind == ContainerValue);
+            node->isReference = (kind == ReferenceValue);
+        }
+        return node;
+    }
+    
+    void QtPropertyTreeModel::addFieldNodes(Node *node, const QMetaObject *gadget)
+    {
+        // Nested gadgets are expanded along with their enclosing value.
+        for(int i = 0; i < gadget->propertyCount(); ++i) {
+            Node *fieldNode = new Node(node);
+            fieldNode->propertyName = QByteArray(gadget->property(i).name());
+            fieldNode->fieldOf = gadget;
+            fieldNode->fieldIndex = i;
+            QMetaType metaType = gadget->property(i).metaType();
+            ValueKind kind = valueKind(metaType);
+            fieldNode->isContainer = (kind == ContainerValue);
+            fieldNode->isReference = (kind == ReferenceValue);
+            if(kind == GadgetValue)
+                addFieldNodes(fieldNode, gadgetMetaObject(metaType));
+            node->children.append(fieldNode);
+        }
+    }
+    
+    QVariant QtPropertyTreeModel::nodeValue(const Node *node) const
+    {
+        // Container elements are read one at a time from their container.
+        if(node->elementIndex >= 0) {
+            QVariant value = pendingElement(node);
+            if(value.isValid())
+                return value;
+            QVariant container = nodeValue(node->parent);
+            if(!container.isValid())
+                return QVariant();
+            QSequentialIterable iterable = container.value<QSequentialIterable>();
+            return node->elementIndex < iterable.size() ? iterable.at(node->elementIndex) : QVariant();
+        }
+        // Gadget fields are read from their enclosing value.
+        if(node->fieldOf) {
+            QVariant value = nodeValue(node->parent);
+            return value.isValid() ? node->fieldOf->property(node->fieldIndex).readOnGadget(value.constData()) : QVariant();
+        }
+        QObject *object = node->parent ? node->parent->object : NULL;
+        return object ? object->property(node->propertyName.constData()) : QVariant();
+    }
+    
+    bool QtPropertyTreeModel::setNodeValue(const Node *node, const QVariant &value)
+    {
+        // Container values are either properties or gadget fields (elements are not expanded further).
+        if(node->fieldOf)
+            return setFieldValue(node, value);
+        QObject *object = node->parent ? node->parent->object : NULL;
+        if(!object || node->elementIndex >= 0)
+            return false;
+        QModelIndex index = indexOfNode(node);
+        index = createIndex(index.row(), 1, index.internalId());
+        if(!writeProperty(index, object, node->propertyName, value))
+            return false;
+        emit dataChanged(index, index);
+        return true;
+    }
+    
+    bool QtPropertyTreeModel::setFieldValue(const Node *node, const QVariant &value)
+    {
+        QList<const Node*> fields;
+        const Node *propertyNode = node;
+        while(propertyNode->fieldOf) {
+            fields.prepend(propertyNode);
+            propertyNode = propertyNode->parent;
+        }
+        QObject *object = propertyNode->parent ? propertyNode->parent->object : NULL;
+        if(!object)
+            return false;
+        // Recorded for undo against the property's own cell.
+        QModelIndex propertyIndex = indexOfNode(propertyNode);
+        propertyIndex = createIndex(propertyIndex.row(), 1, propertyIndex.internalId());
+        auto writeField = [&](QObject *writtenObject) {
+            // Enclosing values from the property down to the field's parent, read once each.
+            QVector<QVariant> values;
+            values.append(writtenObject->property(propertyNode->propertyName.constData()));
+            for(int i = 0; i < fields.size() - 1; ++i)
+                values.append(fields.at(i)->fieldOf->property(fields.at(i)->fieldIndex).readOnGadget(values.last().constData()));
+            // Patch each field into its enclosing value in place, and write the property once.
+            QVariant fieldValue = value;
+            for(int i = fields.size() - 1; i >= 0; --i) {
+                if(!fields.at(i)->fieldOf->property(fields.at(i)->fieldIndex).writeOnGadget(values[i].data(), fieldValue))
+                    return false;
+                fieldValue = values.at(i);
+            }
+            return writeProperty(propertyIndex, writtenObject, propertyNode->propertyName, fieldValue);
+        };
+        bool result = true;
+        if(isMergedPropertyIndex(propertyIndex) && !_isUndoing) {
+            // Patched into each merged object's own value (other fields may differ), as a single undo step.
+            bool isUndoMacro = _undoStack != NULL;
+            if(isUndoMacro)
+                _undoStack->beginMacro(QString("Edit ") + QString(propertyNode->propertyName) + QString(" of ") + QString::number(_objects.size()) + QString(" Objects"));
+            foreach(QObject *mergedObject, _objects) {
+                if(!writeField(mergedObject))
+                    result = false;
+            }
+            if(isUndoMacro)
+                _undoStack->endMacro();
+        } else {
+            result = writeField(object);
+        }
+        // The property and each enclosing field down to the edited one show the new value.
+        QModelIndexList changedIndexes;
+        changedIndexes.append(propertyIndex);
+        foreach(const Node *field, fields) {
+            QModelIndex fieldIndex = indexOfNode(field);
+            changedIndexes.append(createIndex(fieldIndex.row(), 1, fieldIndex.internalId()));
+        }
+        emitDataChanged(changedIndexes);
+        return result;
+    }
+    
+    bool QtPropertyTreeModel::isWritableValueNode(const Node *node) const
+    {
+        // Gadget fields down to the property, which is writable if it is a dynamic property or has a setter.
+        for(; node && node->fieldOf; node = node->parent) {
+            if(!node->fieldOf->property(node->fieldIndex).isWritable())
+                return false;
+        }
+        QObject *object = (node && node->parent) ? node->parent->object : NULL;
+        if(!object)
+            return false;
+        int propertyIndex = object->metaObject()->indexOfProperty(node->propertyName.constData());
+        return propertyIndex < 0 ? object->dynamicPropertyNames().contains(node->propertyName) : object->metaObject()->property(propertyIndex).isWritable();
+    }
+    
+    int QtPropertyTreeModel::containerSize(const QVariant &container)
+    {
+        return container.isValid() ? int(container.value<QSequentialIterable>().size()) : 0;
+    }
+    
+    QObject* QtPropertyTreeModel::referenceTarget(const QVariant &value, const Node *parentNode) const
+    {
+        QObject *target = value.value<QObject*>();
+        if(!target)
+            return NULL;
+        // Objects already visited on the path from the root would lead to endless expansion.
+        for(const Node *ancestor = parentNode; ancestor; ancestor = ancestor->parent) {
+            if(ancestor->object == target)
+                return NULL;
+        }
+        return target;
+    }
+    
+    QVariant QtPropertyTreeModel::pendingElement(const Node *node) const
+    {
+        if(_pendingElements.isEmpty())
+            return QVariant();
+        QModelIndex containerIndex = indexOfNode(node->parent);
+        containerIndex = createIndex(containerIndex.row(), 1, containerIndex.internalId());
+        auto it = _pendingElements.constFind(QPersistentModelIndex(containerIndex));
+        return it != _pendingElements.constEnd() ? it.value().value(node->elementIndex) : QVariant();
+    }
+    
+    void QtPropertyTreeModel::writePendingElements()
+    {
+        // Each container is read once, patched with all of its edited elements, and written back as a single undo step.
+        QHash<QPersistentModelIndex, QMap<int, QVariant> > pendingElements;
+        pendingElements.swap(_pendingElements);
+        _elementWriteTimer.stop();
+        for(auto it = pendingElements.constBegin(); it != pendingElements.constEnd(); ++it) {
+            if(!it.key().isValid())
+                continue;
+            Node *node = nodeAtIndex(it.key());
+            if(!node)
+                continue;
+            QVariant container = nodeValue(node);
+            if(container.isValid()) {
+                QSequentialIterable iterable = container.view<QSequentialIterable>();
+                for(auto element = it.value().constBegin(); element != it.value().constEnd(); ++element) {
+                    if(element.key() < iterable.size())
+                        iterable.set(element.key(), element.value());
+                }
+                setNodeValue(node, container);
+            }
+            // Also if the write failed, so that views revert to the unchanged elements.
+            if(node->children.isEmpty())
+                continue;
+            QModelIndex parentIndex = indexOfNode(node);
+            emit dataChanged(index(0, 1, parentIndex), index(node->children.size() - 1, 1, parentIndex));
+        }
+    }
+    
+    void QtPropertyTreeModel::refreshReferenceNode(Node *node)
+    {
+        // An expanded reference whose target changed is collapsed, and resolved again when next expanded.
+        if(!node || !node->isReference || node->children.isEmpty())
+            return;
+        if(node->children.first()->object != referenceTarget(nodeValue(node), node->parent))
+            removeObjectNode(node->children.first());
+    }
+    
+    void QtPropertyTreeModel::refreshReferenceNodes(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+    {
+        // E.g. undo or an external change of a reference property.
+        if(!_expandReferences || !topLeft.isValid() || topLeft.column() > 1 || bottomRight.column() < 1)
+            return;
+        QModelIndex parent = topLeft.parent();
+        for(int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+            QModelIndex cell = index(row, 0, parent);
+            if(Node *objectNode = propertyRowObjectNode(cell))
+                refreshReferenceNode(objectNode->propertyNodes.value(row, NULL));
+            else
+                refreshReferenceNode(nodeAtIndex(cell));
+        }
+    }
+    
+    bool QtPropertyTreeModel::isMixedValue(const QModelIndex &index) const
+    {
+        return isMergedPropertyIndex(index) && index.row() < _mixedValues.size() && _mixedValues.testBit(index.row());
+    }
+    
+    void QtPropertyTreeModel::updateMixedValues(int firstRow, int lastRow)
+    {
+        lastRow = qMin(lastRow, int(_mixedValues.size()) - 1);
+        for(int row = qMax(0, firstRow); row <= lastRow; ++row) {
+            // Stops at the first object whose value differs from the first object's.
+            const char *propertyName = _root.properties->names.at(row).constData();
+            QVariant value = _objects.first()->property(propertyName);
+            bool isMixed = false;
+            for(int i = 1; i < _objects.size() && !isMixed; ++i)
+                isMixed = (_objects.at(i)->property(propertyName) != value);
+            _mixedValues.setBit(row, isMixed);
+        }
+    }
+    
+    void QtPropertyTreeModel::updateMixedValues(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+    {
+        // Merged property rows are the top-level rows (e.g. undo of a merged edit or refreshValues()).
+        if(isMerged() && topLeft.isValid() && !topLeft.parent().isValid())
+            updateMixedValues(topLeft.row(), bottomRight.row());
+    }
+    
+    QtPropertyTreeModel::Node::PropertyFilter QtPropertyTreeModel::propertyFilter() const
+    {
+        // Unchanged properties are skipped before their rows are created.
+        if(!_showChangedOnly || !_hasBaseline)
+            return Node::PropertyFilter();
+        return [this](const Node *objectNode, const QByteArray &propertyName) {
+            QString path = objectNode->path();
+            path = path.isEmpty() ? QString::fromUtf8(propertyName) : path + QString(".") + QString::fromUtf8(propertyName);
+            auto it = _baseline.constFind(path);
+            return it == _baseline.constEnd() || it.value() != valueHash(objectNode->object->property(propertyName.constData()));
+        };
+    }
+    
+    void QtPropertyTreeModel::baselineChanged()
+    {
+        if(_showChangedOnly)
+            reset();
+        else
+            QtAbstractPropertyModel::baselineChanged();
+    }
+    
+    void QtPropertyTreeModel::storeValues() const
+    {
+        _storedValues.clear();
+        _numDroppedValues = 0;
+        storeNodeValues(&_root);
+    }
+    
+    void QtPropertyTreeModel::storeNodeValues(const Node *node) const
+    {
+        // Depth first, each object's objectName followed by its property values. Gadget fields and container elements
+        // are derived from their stored enclosing values (see storedNodeValue()).
+        if(node->object) {
+            node->valueIndex = _storedValues.size();
+            _storedValues.append(QVariant(node->object->objectName()));
+            int numPropertyRows = node->numPropertyRows();
+            for(int row = 0; row < numPropertyRows; ++row)
+                _storedValues.append(node->object->property(node->properties->names.at(row).constData()));
+        }
+        foreach(Node *child, node->children)
+            storeNodeValues(child);
+        // Referenced objects of expanded values.
+        foreach(Node *propertyNode, node->propertyNodes)
+            storeNodeValues(propertyNode);
+    }
+    
+    void QtPropertyTreeModel::dropNodeValues(const Node *node) const
+    {
+        if(node->object && node->valueIndex >= 0) {
+            int last = qMin(node->valueIndex + node->numPropertyRows(), int(_storedValues.size()) - 1);
+            for(int i = node->valueIndex; i <= last; ++i)
+                _storedValues[i] = QVariant();
+            _numDroppedValues += last - node->valueIndex + 1;
+            node->valueIndex = -1;
+        }
+        foreach(Node *child, node->children)
+            dropNodeValues(child);
+        foreach(Node *propertyNode, node->propertyNodes)
+            dropNodeValues(propertyNode);
+    }
+    
+    void QtPropertyTreeModel::valueStoreRowsInserted(const QModelIndex &parent, int first, int last)
+    {
+        // Only object nodes have values of their own (e.g. fetched container elements add nothing).
+        if(!_isValueStoreValid)
+            return;
+        for(int row = first; row <= last; ++row) {
+            if(Node *node = nodeAtIndex(index(row, 0, parent)))
+                storeNodeValues(node);
+        }
+    }
+    
+    void QtPropertyTreeModel::valueStoreRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+    {
+        // The nodes are deleted by the time the rows are removed.
+        if(!_isValueStoreValid)
+            return;
+        for(int row = first; row <= last; ++row) {
+            if(Node *node = nodeAtIndex(index(row, 0, parent)))
+                dropNodeValues(node);
+        }
+    }
+    
+    void QtPropertyTreeModel::valueStoreRowsRemoved(const QModelIndex &parent, int first, int last)
+    {
+        Q_UNUSED(parent);
+        Q_UNUSED(first);
+        Q_UNUSED(last);
+        if(!_isValueStoreValid || !_numDroppedValues || 2 * _numDroppedValues < _storedValues.size())
+            return;
+        // Compact the remaining values in tree order, without reading the objects again.
+        QVector<QVariant> storedValues;
+        std::function<void(const Node*)> moveNodeValues = [&](const Node *node) {
+            if(node->object && node->valueIndex >= 0) {
+                int valueIndex = node->valueIndex;
+                node->valueIndex = storedValues.size();
+                storedValues.append(_storedValues.mid(valueIndex, 1 + node->numPropertyRows()));
+            }
+            foreach(Node *child, node->children)
+                moveNodeValues(child);
+            foreach(Node *propertyNode, node->propertyNodes)
+                moveNodeValues(propertyNode);
+        };
+        moveNodeValues(&_root);
+        _storedValues.swap(storedValues);
+        _numDroppedValues = 0;
+    }
+    
+    QVariant QtPropertyTreeModel::storedNodeValue(const Node *node) const
+    {
+        if(!node)
+            return QVariant();
+        if(node->object)
+            return (node->valueIndex >= 0 && node->valueIndex < _storedValues.size()) ? _storedValues.at(node->valueIndex) : QVariant();
+        if(node->propertyRow >= 0) {
+            int valueIndex = node->parent->valueIndex + 1 + node->propertyRow;
+            return (node->parent->valueIndex >= 0 && valueIndex < _storedValues.size()) ? _storedValues.at(valueIndex) : QVariant();
+        }
+        if(node->fieldOf) {
+            QVariant value = storedNodeValue(node->parent);
+            return value.isValid() ? node->fieldOf->property(node->fieldIndex).readOnGadget(value.constData()) : QVariant();
+        }
+        if(node->elementIndex >= 0) {
+            QVariant container = storedNodeValue(node->parent);
+            if(!container.isValid())
+                return QVariant();
+            QSequentialIterable iterable = container.value<QSequentialIterable>();
+            return node->elementIndex < iterable.size() ? iterable.at(node->elementIndex) : QVariant();
+        }
+        return QVariant();
+    }
+    
+    QVariant QtPropertyTreeModel::storedValue(const QModelIndex &index) const
+    {
+        if(const Node *objectNode = propertyRowObjectNode(index)) {
+            int valueIndex = objectNode->valueIndex + 1 + index.row();
+            return (objectNode->valueIndex >= 0 && valueIndex < _storedValues.size()) ? _storedValues.at(valueIndex) : QVariant();
+        }
+        return storedNodeValue(nodeAtIndex(index));
+    }
+    
+    QtPropertyTreeModel::Node* QtPropertyTreeModel::nodeAtIndex(const QModelIndex &index) const
+    {
+        if(!index.isValid())
+            return NULL;
+        if(Node *objectNode = propertyRowObjectNode(index))
+            return objectNode->propertyNodes.value(index.row(), NULL);
+        return static_cast<Node*>(index.internalPointer());
+    }
+    
+    QObject* QtPropertyTreeModel::objectAtIndex(const QModelIndex &index) const
+    {
+        // If index is a property row, return its object node's object.
+        // Else if node is an object, return the node's object.
+        if(Node *objectNode = propertyRowObjectNode(index))
+            return objectNode->object;
+        Node *node = nodeAtIndex(index);
+        if(!node) return NULL;
+        if(node->object) return node->object;
+        if(node->groupClass) return NULL;
+        for(Node *ancestor = node->parent; ancestor; ancestor = ancestor->parent) {
+            // Skip the enclosing properties of gadget fields.
+            if(ancestor->object) return ancestor->object;
+        }
+        return NULL;
+    }
+    
+    QByteArray QtPropertyTreeModel::propertyNameAtIndex(const QModelIndex &index) const
+    {
+        // If index is a property row, return the property name.
+        // Else (objects, gadget fields and container elements, which are not properties of the object) return an empty name.
+        if(Node *objectNode = propertyRowObjectNode(index))
+            return objectNode->properties->names.at(index.row());
+        return QByteArray();
+    }
+    
+    QModelIndex QtPropertyTreeModel::index(int row, int column, const QModelIndex &parent) const
+    {
+        // Property rows refer to their object node, other rows to their own node.
+        if(column < 0 || column >= 2 || row < 0)
+            return QModelIndex();
+        const Node *parentNode = parent.isValid() ? nodeAtIndex(parent) : &_root;
+        if(!parentNode)
+            return QModelIndex();
+        int numPropertyRows = parentNode->numPropertyRows();
+        if(row < numPropertyRows)
+            return propertyRowIndex(parentNode, row, column);
+        row -= numPropertyRows;
+        if(row >= parentNode->children.size())
+            return QModelIndex();
+        return createIndex(numPropertyRows + row, column, parentNode->children.at(row));
+    }
+    
+    QModelIndex QtPropertyTreeModel::parent(const QModelIndex &index) const
+    {
+        // Return a model index for parent node (column must be 0).
+        if(!index.isValid())
+            return QModelIndex();
+        if(Node *objectNode = propertyRowObjectNode(index))
+            return indexOfNode(objectNode);
+        Node *node = nodeAtIndex(index);
+        return node ? indexOfNode(node->parent) : QModelIndex();
+    }
+    
+    int QtPropertyTreeModel::rowCount(const QModelIndex &parent) const
+    {
+        // Property rows followed by child nodes.
+        const Node *parentNode = parent.isValid() ? nodeAtIndex(parent) : &_root;
+        return parentNode ? parentNode->numPropertyRows() + parentNode->children.size() : 0;
+    }
+    
+    int QtPropertyTreeModel::columnCount(const QModelIndex &/* parent */) const
+    {
+        // Return 2 for name/value columns.
+        return 2;
+    }
+    
+    static QVariant referenceDisplayValue(const QVariant &value)
+    {
+        // Referenced object's objectName, or else its class name.
+        QObject *target = value.value<QObject*>();
+        if(!target)
+            return QVariant();
+        return QVariant(target->objectName().isEmpty() ? QString(target->metaObject()->className()) : target->objectName());
+    }
+    
+    QVariant QtPropertyTreeModel::data(const QModelIndex &index, int role) const
+    {
+        if(!index.isValid())
+            return QVariant();
+        if(Node *objectNode = propertyRowObjectNode(index)) {
+            const QByteArray &propertyName = objectNode->properties->names.at(index.row());
+            if(role == Qt::DisplayRole || role == Qt::EditRole) {
+                if(index.column() == 0)
+                    return propertyHeaders.contains(propertyName) ? QVariant(propertyHeaders[propertyName]) : QVariant(propertyName);
+                QVariant value = _isReadOnly ? valueFromStore(index) : objectNode->object->property(propertyName.constData());
+                if(role == Qt::DisplayRole && valueKind(value.metaType()) == ReferenceValue)
+                    return referenceDisplayValue(value);
+                return value;
+            }
+            if(role == MixedValueRole)
+                return (index.column() == 1 && isMerged()) ? QVariant(isMixedValue(index)) : QVariant();
+            return baselineData(index, role);
+        }
+        Node *node = nodeAtIndex(index);
+        if(!node)
+            return QVariant();
+        if(node->groupClass) {
+            // Class name and number of objects.
+            if(role == Qt::DisplayRole)
+                return index.column() == 0 ? QVariant(node->groupClass->className()) : QVariant(QString("[") + QString::number(node->children.size()) + QString("]"));
+            return QVariant();
+        }
+        if((node->fieldOf || node->elementIndex >= 0) && (role == Qt::DisplayRole || role == Qt::EditRole)) {
+            // Field name or value of a gadget field or container element.
+            if(index.column() == 0)
+                return QVariant(propertyHeaders.value(node->propertyName, QString::fromUtf8(node->propertyName)));
+            QVariant value = _isReadOnly ? valueFromStore(index) : nodeValue(node);
+            if(role == Qt::DisplayRole && node->isReference)
+                return referenceDisplayValue(value);
+            return value;
+        }
+        if(node->object && (role == Qt::DisplayRole || role == Qt::EditRole)) {
+            // Object's class name and objectName.
+            if(index.column() == 0)
+                return QVariant(node->object->metaObject()->className());
+            return _isReadOnly ? valueFromStore(index) : QVariant(node->object->objectName());
+        }
+        return baselineData(index, role);
+    }
+    
+    bool QtPropertyTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
+    {
+        if(!index.isValid() || _isReadOnly || role != Qt::EditRole || index.column() != 1)
+            return false;
+        if(Node *objectNode = propertyRowObjectNode(index)) {
+            QObject *object = objectNode->object;
+            const QByteArray propertyName = objectNode->properties->names.at(index.row());
+            if(isMergedPropertyIndex(index) && !_isUndoing) {
+                // Write to all merged objects as a single undo step (undo restores each object separately).
+                bool isUndoMacro = _undoStack != NULL;
+                if(isUndoMacro)
+                    _undoStack->beginMacro(QString("Edit ") + QString(propertyName) + QString(" of ") + QString::number(_objects.size()) + QString(" Objects"));
+                bool result = true;
+                foreach(QObject *mergedObject, _objects) {
+                    if(!writeProperty(index, mergedObject, propertyName, value))
+                        result = false;
+                }
+                if(isUndoMacro)
+                    _undoStack->endMacro();
+                updateMixedValues(index.row(), index.row());
+                return result;
+            }
+            if(!writeProperty(index, object, propertyName, value))
+                return false;
+            refreshReferenceNode(objectNode->propertyNodes.value(index.row(), NULL));
+            return true;
+        }
+        Node *node = nodeAtIndex(index);
+        if(!node)
+            return false;
+        if(node->fieldOf)
+            return setFieldValue(node, value);
+        if(node->elementIndex >= 0) {
+            // Checked up front, as failures of the deferred write can only be reported by reverting the views.
+            if(!isWritableValueNode(node->parent))
+                return false;
+            QMetaType elementType = nodeValue(node->parent).value<QSequentialIterable>().metaContainer().valueMetaType();
+            if(elementType != QMetaType::fromType<QVariant>() && !value.canConvert(elementType))
+                return false;
+            // Written back together with any other edits to the same container.
+            QModelIndex containerIndex = index.parent();
+            containerIndex = createIndex(containerIndex.row(), 1, containerIndex.internalId());
+            _pendingElements[QPersistentModelIndex(containerIndex)].insert(node->elementIndex, value);
+            _elementWriteTimer.start();
+            emit dataChanged(index, index);
+            return true;
+        }
+        // Object's objectName.
+        if(node->object)
+            return writeProperty(index, node->object, "objectName", QVariant(value.toString()));
+        return false;
+    }
+    
+    Qt::ItemFlags QtPropertyTreeModel::flags(const QModelIndex &index) const
+    {
+        Qt::ItemFlags flags = QAbstractItemModel::flags(index);
+        if(!index.isValid())
+            return flags;
+        if(_isReadOnly)
+            return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+        QObject *object = objectAtIndex(index);
+        if(!object)
+            return flags;
+        flags |= Qt::ItemIsEnabled;
+        flags |= Qt::ItemIsSelectable;
+        if(index.column() == 1) {
+            QByteArray propertyName = propertyNameAtIndex(index);
+            const QMetaProperty metaProperty = metaPropertyAtIndex(index);
+            if(metaProperty.isWritable() || object->dynamicPropertyNames().contains(propertyName) || objectAtIndex(index))
+                flags |= Qt::ItemIsEditable;
+        }
+        return flags;
+    }
+    
+    bool QtPropertyTreeModel::hasChildren(const QModelIndex &parent) const
+    {
+        // Expandable values show an expand indicator before anything is fetched.
+        if(!parent.isValid() || parent.column() != 0)
+            return QtAbstractPropertyModel::hasChildren(parent);
+        Node *node = nodeAtIndex(parent);
+        if(Node *objectNode = node ? NULL : propertyRowObjectNode(parent)) {
+            // Property whose value has not been expanded yet.
+            switch(valueKind(propertyType(objectNode, parent.row()))) {
+                case GadgetValue:
+                    return gadgetMetaObject(propertyType(objectNode, parent.row()))->propertyCount() > 0;
+                case ContainerValue:
+                    return containerSize(objectNode->object->property(objectNode->properties->names.at(parent.row()).constData())) > 0;
+                case ReferenceValue:
+                    return referenceTarget(objectNode->object->property(objectNode->properties->names.at(parent.row()).constData()), objectNode);
+                default:
+                    return false;
+            }
+        }
+        if(node && node->isContainer)
+            return !node->children.isEmpty() || containerSize(nodeValue(node)) > 0;
+        if(node && node->isReference)
+            return !node->children.isEmpty() || referenceTarget(nodeValue(node), node->parent);
+        return QtAbstractPropertyModel::hasChildren(parent);
+    }
+    
+    bool QtPropertyTreeModel::canFetchMore(const QModelIndex &parent) const
+    {
+        if(!parent.isValid())
+            return false;
+        Node *node = nodeAtIndex(parent);
+        if(!node && propertyRowObjectNode(parent))
+            return hasChildren(createIndex(parent.row(), 0, parent.internalId())); // Value nodes are created by fetchMore().
+        if(node && node->isReference)
+            return node->children.isEmpty() && referenceTarget(nodeValue(node), node->parent);
+        return node && node->isContainer && node->children.size() < containerSize(nodeValue(node));
+    }
+    
+    void QtPropertyTreeModel::fetchMore(const QModelIndex &parent)
+    {
+        if(!parent.isValid())
+            return;
+        QModelIndex parentIndex = createIndex(parent.row(), 0, parent.internalId());
+        Node *node = nodeAtIndex(parentIndex);
+        if(Node *objectNode = node ? NULL : propertyRowObjectNode(parentIndex)) {
+            // Node of a property whose value is expanded for the first time.
+            node = propertyNode(objectNode, parentIndex.row());
+            QMetaType metaType = propertyType(objectNode, parentIndex.row());
+            if(valueKind(metaType) == GadgetValue) {
+                const QMetaObject *gadget = gadgetMetaObject(metaType);
+                if(gadget->propertyCount()) {
+                    beginInsertRows(parentIndex, 0, gadget->propertyCount() - 1);
+                    addFieldNodes(node, gadget);
+                    endInsertRows();
+                }
+                return;
+            }
+        }
+        if(node && node->isReference) {
+            // Referenced object's own properties (its references are in turn expanded on demand).
+            QObject *target = node->children.isEmpty() ? referenceTarget(nodeValue(node), node->parent) : NULL;
+            if(!target)
+                return;
+            Node *targetNode = new Node(node);
+            setNodeObject(targetNode, target, 0, propertyFilter());
+            beginInsertRows(parentIndex, 0, 0);
+            node->children.append(targetNode);
+            endInsertRows();
+            trackObjectNode(targetNode);
+            return;
+        }
+        // Next window of element nodes (elements themselves are only read when shown).
+        if(!node || !node->isContainer)
+            return;
+        int first = node->children.size();
+        int count = qMin(_containerFetchSize, containerSize(nodeValue(node)) - first);
+        if(count <= 0)
+            return;
+        beginInsertRows(parentIndex, first, first + count - 1);
+        for(int i = first; i < first + count; ++i) {
+            Node *elementNode = new Node(node);
+            elementNode->propertyName = QByteArray("[") + QByteArray::number(i) + QByteArray("]");
+            elementNode->elementIndex = i;
+            node->children.append(elementNode);
+        }
+        endInsertRows();
+    }
+    
+    QString QtPropertyTreeModel::propertyPathAtIndex(const QModelIndex &index) const
+    {
+        if(Node *objectNode = propertyRowObjectNode(index)) {
+            QString path = objectNode->path();
+            QString propertyName = QString::fromUtf8(objectNode->properties->names.at(index.row()));
+            return path.isEmpty() ? propertyName : path + QString(".") + propertyName;
+        }
+        Node *node = nodeAtIndex(index);
+        return node ? node->path() : QString();
+    }
+    
+    bool QtPropertyTreeModel::isPropertyValueIndex(const QModelIndex &index) const
+    {
+        // Value column of property rows, gadget fields and container elements (object nodes' objectName is also listed as one of its properties).
+        if(index.column() != 1)
+            return false;
+        if(propertyRowObjectNode(index))
+            return true;
+        Node *node = nodeAtIndex(index);
+        return node && (node->fieldOf || node->elementIndex >= 0);
+    }
+    
+    bool QtPropertyTreeModel::isWritableIndex(const QModelIndex &index) const
+    {
+        // Gadget fields and container elements are written back via their property (see setData()).
+        if(propertyRowObjectNode(index))
+            return QtAbstractPropertyModel::isWritableIndex(index);
+        Node *node = nodeAtIndex(index);
+        if(!node || index.column() != 1)
+            return false;
+        if(node->fieldOf)
+            return isWritableValueNode(node);
+        if(node->elementIndex >= 0)
+            return isWritableValueNode(node->parent);
+        return node->object != NULL;
+    }
+    
+    QVariant QtPropertyTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+    {
+        if(role == Qt::DisplayRole) {
+            if(orientation == Qt::Horizontal) {
+                if(section == 0)
+                    return QVariant("Name");
+                else if(section == 1)
+                    return QVariant("Value");
+            }
+        }
+        return QVariant();
+    }
+    
+    QtPropertyTableModel::QtPropertyTableModel(QObject *parent) : QtAbstractPropertyModel(parent)
+    {
+        _removeDestroyedRowsTimer.setSingleShot(true);
+        _removeDestroyedRowsTimer.setInterval(0);
+        connect(&_removeDestroyedRowsTimer, SIGNAL(timeout()), this, SLOT(removeDestroyedRows()));
+        connect(this, SIGNAL(modelReset()), this, SLOT(clearObjectRows()));
+        connect(this, SIGNAL(layoutChanged()), this, SLOT(clearObjectRows()));
+        connect(this, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(clearObjectRows()));
+        connect(this, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(clearObjectRows()));
+        connect(this, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), this, SLOT(clearObjectRows()));
+        
+        // Cached values (and with them the column stats) are dirtied by data changes.
+        connect(this, SIGNAL(dataChanged(QModelIndex, QModelIndex, QList<int>)), this, SLOT(invalidateCachedValues(QModelIndex, QModelIndex, QList<int>)));
+    }
+    
+    bool QtPropertyTableModel::isNumericColumn(int column) const
+    {
+        // Column type is taken from the first row, as all rows are expected to be the same type of object.
+        // In windowed mode it is taken from the most recently used page instead, so that no page is pulled in.
+        if(!rowCount() || column < 0 || column >= columnCount())
+            return false;
+        if(_objectProvider && _recentPages.isEmpty())
+            return false;
+        QModelIndex index = createIndex(_objectProvider ? _recentPages.last() * _pageSize : 0, column);
+        const QMetaProperty metaProperty = metaPropertyAtIndex(index);
+        if(metaProperty.isValid() && metaProperty.isEnumType())
+            return false;
+        return isNumericTypeId(data(index).typeId());
+    }
+    
+    QtPropertyTableModel::ColumnStats QtPropertyTableModel::columnStats(int column) const
+    {
+        if(!isNumericColumn(column))
+            return ColumnStats();
+        if(_objectProvider) {
+            // Held pages only, without changing their use order.
+            ValueColumn valueColumn;
+            valueColumn.statsValid = true;
+            QList<int> recentPages = _recentPages;
+            foreach(int pageIndex, recentPages) {
+                int firstRow = pageIndex * _pageSize;
+                int numRows = _pages.value(pageIndex).objects.size();
+                for(int row = firstRow; row < firstRow + numRows; ++row) {
+                    QVariant value = pageValue(row, column);
+                    valueColumn.addToStats(isNumericTypeId(value.typeId()) ? value.toDouble() : qQNaN());
+                }
+            }
+            _recentPages = recentPages;
+            return valueColumn.stats;
+        }
+        if(!_isValueCacheEnabled && !_isReadOnly) {
+            // Single pass over the live values, so changes without notifications are included.
+            ValueColumn valueColumn;
+            valueColumn.statsValid = true;
+            int numRows = rowCount();
+            for(int row = 0; row < numRows; ++row) {
+                QVariant value = propertyValue(createIndex(row, column));
+                valueColumn.addToStats(isNumericTypeId(value.typeId()) ? value.toDouble() : qQNaN());
+            }
+            return valueColumn.stats;
+        }
+        // Dirty cells are re-read first, which adds them to valid stats.
+        ValueColumn &cachedColumn = valueColumn(column);
+        int numRows = cachedColumn.dirty.size();
+        if(cachedColumn.dirty.count(true)) {
+            for(int row = 0; row < numRows; ++row) {
+                if(cachedColumn.dirty.testBit(row))
+                    setCellValue(cachedColumn, row, propertyValue(createIndex(row, column)));
+            }
+        }
+        if(!cachedColumn.statsValid) {
+            // Single pass over the column's cached values.
+            cachedColumn.stats = ColumnStats();
+            cachedColumn.statsValid = true;
+            for(int row = 0; row < numRows; ++row)
+                cachedColumn.addToStats(cachedColumn.numericValue(row));
+        }
+        return cachedColumn.stats;
+    }
+    
+    double QtPropertyTableModel::ValueColumn::numericValue(int row) const
+    {
+        switch(storage) {
+            case DoubleStorage:
+                return doubles.at(row);
+            case IntStorage:
+                return ints.at(row);
+            case VariantStorage:
+                return isNumericTypeId(variants.at(row).typeId()) ? variants.at(row).toDouble() : qQNaN();
+            default:
+                return qQNaN();
+        }
+    }
+    
+    void QtPropertyTableModel::ValueColumn::addToStats(double value)
+    {
+        if(!statsValid || qIsNaN(value))
+            return;
+        if(stats.count == 0) {
+            stats.min = value;
+            stats.max = value;
+        } else {
+            stats.min = qMin(stats.min, value);
+            stats.max = qMax(stats.max, value);
+        }
+        stats.sum += value;
+        ++stats.count;
+    }
+    
+    void QtPropertyTableModel::ValueColumn::removeFromStats(double value)
+    {
+        if(!statsValid || qIsNaN(value))
+            return;
+        // The new min or max is only known after a full pass.
+        if(value == stats.min || value == stats.max) {
+            statsValid = false;
+            return;
+        }
+        stats.sum -= value;
+        --stats.count;
+    }
+    
+    // QBitArray has no insert or remove, so the bits after the range are shifted one by one.
+    static void insertBits(QBitArray &bits, int first, int count, bool value)
+    {
+        int oldSize = bits.size();
+        bits.resize(oldSize + count);
+        for(int i = oldSize - 1; i >= first; --i)
+            bits.setBit(i + count, bits.testBit(i));
+        if(count)
+            bits.fill(value, first, first + count);
+    }
+    
+    static void removeBits(QBitArray &bits, int first, int count)
+    {
+        int newSize = bits.size() - count;
+        for(int i = first; i < newSize; ++i)
+            bits.setBit(i, bits.testBit(i + count));
+        bits.resize(newSize);
+    }
+    
+    void QtPropertyTableModel::ValueColumn::insertRows(int row, int count)
+    {
+        // Inserted cells are dirty, so the stats (of clean cells) stay valid.
+        switch(storage) {
+            case DoubleStorage:
+                doubles.insert(row, count, 0);
+                break;
+            case IntStorage:
+                ints.insert(row, count, 0);
+                break;
+            case BoolStorage:
+                insertBits(bools, row, count, false);
+                break;
+            case StringStorage:
+                stringIds.insert(row, count, 0);
+                break;
+            default:
+                variants.insert(row, count, QVariant());
+        }
+        insertBits(dirty, row, count, true);
+    }
+    
+    void QtPropertyTableModel::ValueColumn::removeRows(int row, int count)
+    {
+        for(int i = row; i < row + count && statsValid; ++i) {
+            if(!dirty.testBit(i))
+                removeFromStats(numericValue(i));
+        }
+        switch(storage) {
+            case DoubleStorage:
+                doubles.remove(row, count);
+                break;
+            case IntStorage:
+                ints.remove(row, count);
+                break;
+            case BoolStorage:
+                removeBits(bools, row, count);
+                break;
+            case StringStorage:
+                stringIds.remove(row, count);
+                break;
+            default:
+                variants.remove(row, count);
+        }
+        removeBits(dirty, row, count);
+    }
+    
+    QObject* QtPropertyTableModel::objectAtIndex(const QModelIndex &index) const
+    {
+        QObject *object = rowObject(index.row());
+        if(!object)
+            return 0;
+        // If property names are specified, check if name at column is a path to a child object property.
+        if(!propertyNames.isEmpty()) {
+            if(propertyNames.size() > index.column()) {
+                QByteArray propertyName = propertyNames.at(index.column());
+                if(propertyName.contains('.')) {
+                    int pos = propertyName.lastIndexOf('.');
+                    return descendant(object, propertyName.left(pos));
+                }
+            }
+        }
+        return object;
+    }
+    
+    QByteArray QtPropertyTableModel::propertyNameAtIndex(const QModelIndex &index) const
+    {
+        // If property names are specified, return the name at column.
+        if(!propertyNames.isEmpty()) {
+            if(propertyNames.size() > index.column()) {
+                QByteArray propertyName = propertyNames.at(index.column());
+                if(propertyName.contains('.')) {
+                    int pos = propertyName.lastIndexOf('.');
+                    return propertyName.mid(pos + 1);
+                }
+                return propertyName;
+            }
+            return QByteArray();
+        }
+        // If property names are NOT specified, return the metaObject's property name at column.
+        QObject *object = objectAtIndex(index);
+        if(!object)
+            return QByteArray();
+        const QMetaObject *metaObject = object->metaObject();
+        int numProperties = metaObject->propertyCount();
+        if(numProperties > index.column())
+            return QByteArray(metaObject->property(index.column()).name());
+        // If column is greater than the number of metaObject properties, check for dynamic properties.
+        const QList<QByteArray> &dynamicPropertyNames = object->dynamicPropertyNames();
+        if(numProperties + dynamicPropertyNames.size() > index.column())
+            return dynamicPropertyNames.at(index.column() - numProperties);
+        return QByteArray();
+    }
+    
+    QModelIndex QtPropertyTableModel::index(int row, int column, const QModelIndex &/* parent */) const
+    {
+        return createIndex(row, column);
+    }
+    
+    QModelIndex QtPropertyTableModel::parent(const QModelIndex &/* index */) const
+    {
+        return QModelIndex();
+    }
+    
+    int QtPropertyTableModel::rowCount(const QModelIndex &/* parent */) const
+    {
+        return _objectProvider ? _providerRowCount : _objects.size();
+    }
+    
+    int QtPropertyTableModel::columnCount(const QModelIndex &/* parent */) const
+    {
+        // Number of properties.
+        if(!propertyNames.isEmpty())
+            return propertyNames.size();
+        if(_objectProvider)
+            return _providerColumnCount;
+        // First row whose object has not been destroyed.
+        foreach(QObject *object, _objects) {
+            if(object)
+                return object->metaObject()->propertyCount() + object->dynamicPropertyNames().size();
+        }
+        return 0;
+    }
+    
+    bool QtPropertyTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+    {
+        if(!QtAbstractPropertyModel::setData(index, value, role))
+            return false;
+        invalidateCachedValues(index, index);
+        return true;
+    }
+    
+    QVariant QtPropertyTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+    {
+        if(role == Qt::ToolTipRole && orientation == Qt::Horizontal && _showColumnStats) {
+            // min, max, mean and sum for numeric columns.
+            if(!isNumericColumn(section))
+                return QVariant();
+            ColumnStats stats = columnStats(section);
+            if(!stats.count)
+                return QVariant();
+            return QVariant(QString("min: ") + QString::number(stats.min)
+                            + QString("\nmax: ") + QString::number(stats.max)
+                            + QString("\nmean: ") + QString::number(stats.mean())
+                            + QString("\nsum: ") + QString::number(stats.sum)
+                            + QString("\ncount: ") + QString::number(stats.count));
+        }
+        if(role == Qt::DisplayRole) {
+            if(orientation == Qt::Vertical) {
+                return QVariant(section);
+            } else if(orientation == Qt::Horizontal) {
+                QByteArray propertyName = propertyNameAtIndex(createIndex(0, section));
+                QByteArray childPath;
+                if(propertyNames.size() > section) {
+                    QByteArray pathToPropertyName = propertyNames.at(section);
+                    if(pathToPropertyName.contains('.')) {
+                        int pos = pathToPropertyName.lastIndexOf('.');
+                        childPath = pathToPropertyName.left(pos + 1);
+                    }
+                }
+                if(propertyHeaders.contains(propertyName))
+                    return QVariant(childPath + propertyHeaders.value(propertyName));
+                return QVariant(childPath + propertyName);
+            }
+        }
+        return QVariant();
+    }
+    
+    QtPropertyTableModel::ValueColumn& QtPropertyTableModel::valueColumn(int column) const
+    {
+        int numRows = rowCount();
+        if(_valueColumns.size() != columnCount())
+            _valueColumns.resize(columnCount());
+        ValueColumn &valueColumn = _valueColumns[column];
+        if(valueColumn.dirty.size() != numRows) {
+            // Storage type is taken from the first row, as all rows are expected to be the same type of object.
+            // All cells start out dirty.
+            valueColumn = ValueColumn();
+            int typeId = numRows ? propertyValue(createIndex(0, column)).typeId() : QMetaType::UnknownType;
+            if(typeId == QMetaType::Double) {
+                valueColumn.storage = ValueColumn::DoubleStorage;
+                valueColumn.doubles.resize(numRows);
+            } else if(typeId == QMetaType::Int) {
+                valueColumn.storage = ValueColumn::IntStorage;
+                valueColumn.ints.resize(numRows);
+            } else if(typeId == QMetaType::Bool) {
+                valueColumn.storage = ValueColumn::BoolStorage;
+                valueColumn.bools.resize(numRows);
+            } else if(typeId == QMetaType::QString) {
+                valueColumn.storage = ValueColumn::StringStorage;
+                valueColumn.stringIds.resize(numRows);
+            } else {
+                valueColumn.variants.resize(numRows);
+            }
+            valueColumn.dirty.fill(true, numRows);
+        }
+        return valueColumn;
+    }
+    
+    QVariant QtPropertyTableModel::cellValue(const ValueColumn &valueColumn, const QStringList &internedStrings, int row)
+    {
+        switch(valueColumn.storage) {
+            case ValueColumn::DoubleStorage:
+                return QVariant(valueColumn.doubles.at(row));
+            case ValueColumn::IntStorage:
+                return QVariant(valueColumn.ints.at(row));
+            case ValueColumn::BoolStorage:
+                return QVariant(valueColumn.bools.testBit(row));
+            case ValueColumn::StringStorage:
+                return QVariant(internedStrings.at(valueColumn.stringIds.at(row)));
+            default:
+                return valueColumn.variants.at(row);
+        }
+    }
+    
+    void QtPropertyTableModel::setCellValue(ValueColumn &valueColumn, int row, const QVariant &value) const
+    {
+        static const int storageTypeIds[] = { QMetaType::Double, QMetaType::Int, QMetaType::Bool, QMetaType::QString };
+        if(!valueColumn.dirty.testBit(row))
+            valueColumn.removeFromStats(valueColumn.numericValue(row));
+        if(valueColumn.storage != ValueColumn::VariantStorage && value.typeId() != storageTypeIds[valueColumn.storage]) {
+            // Value doesn't match the column's storage type (e.g. invalid), so fall back to QVariant storage.
+            int numRows = valueColumn.dirty.size();
+            QVector<QVariant> variants(numRows);
+            for(int i = 0; i < numRows; ++i) {
+                if(!valueColumn.dirty.testBit(i))
+                    variants[i] = cellValue(valueColumn, _internedStrings, i);
+            }
+            valueColumn.doubles.clear();
+            valueColumn.ints.clear();
+            valueColumn.bools.clear();
+            valueColumn.stringIds.clear();
+            valueColumn.variants = variants;
+            valueColumn.storage = ValueColumn::VariantStorage;
+        }
+        switch(valueColumn.storage) {
+            case ValueColumn::DoubleStorage:
+                valueColumn.doubles[row] = value.toDouble();
+                break;
+            case ValueColumn::IntStorage:
+                valueColumn.ints[row] = value.toInt();
+                break;
+            case ValueColumn::BoolStorage:
+                valueColumn.bools.setBit(row, value.toBool());
+                break;
+            case ValueColumn::StringStorage: {
+                // Repeated strings (e.g. names and units) are stored once.
+                QString str = value.toString();
+                auto it = _internedStringIds.constFind(str);
+                if(it == _internedStringIds.constEnd()) {
+                    if(_internedStrings.size() >= _maxInternedStrings)
+                        compactInternedStrings();
+                    it = _internedStringIds.insert(str, _internedStrings.size());
+                    _internedStrings.append(str);
+                }
+                valueColumn.stringIds[row] = it.value();
+                break;
+            }
+            default:
+                valueColumn.variants[row] = value;
+        }
+        valueColumn.dirty.clearBit(row);
+        valueColumn.addToStats(valueColumn.numericValue(row));
+    }
+    
+    void QtPropertyTableModel::compactInternedStrings() const
+    {
+        // Strings of cells that have since changed are dropped, and the cached cells are renumbered.
+        QStringList internedStrings;
+        QHash<QString, int> internedStringIds;
+        for(int column = 0; column < _valueColumns.size(); ++column) {
+            ValueColumn &valueColumn = _valueColumns[column];
+            if(valueColumn.storage != ValueColumn::StringStorage)
+                continue;
+            int numRows = valueColumn.dirty.size();
+            for(int row = 0; row < numRows; ++row) {
+                if(valueColumn.dirty.testBit(row))
+                    continue;
+                const QString &str = _internedStrings.at(valueColumn.stringIds.at(row));
+                auto it = internedStringIds.constFind(str);
+                if(it == internedStringIds.constEnd()) {
+                    it = internedStringIds.insert(str, internedStrings.size());
+                    internedStrings.append(str);
+                }
+                valueColumn.stringIds[row] = it.value();
+            }
+        }
+        _internedStrings.swap(internedStrings);
+        _internedStringIds.swap(internedStringIds);
+        // Grows with the number of strings in use, so compaction stays rare.
+        _maxInternedStrings = qMax(4096, 2 * int(_internedStrings.size()));
+    }
+    
+    QVariant QtPropertyTableModel::cachedValue(int row, int column) const
+    {
+        if(row < 0 || row >= rowCount() || column < 0 || column >= columnCount())
+            return QVariant();
+        if(_objectProvider)
+            return pageValue(row, column);
+        ValueColumn &cachedColumn = valueColumn(column);
+        if(cachedColumn.dirty.testBit(row))
+            setCellValue(cachedColumn, row, propertyValue(createIndex(row, column)));
+        return cellValue(cachedColumn, _internedStrings, row);
+    }
+    
+    void QtPropertyTableModel::invalidateCachedValues(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+    {
+        // Read-only values only change on refreshValues(), and non-value roles (e.g. diff highlighting) don't affect values.
+        if(_isReadOnly || (_valueColumns.isEmpty() && _pages.isEmpty()))
+            return;
+        if(!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole))
+            return;
+        for(auto it = _pages.begin(); it != _pages.end(); ++it) {
+            Page &page = it.value();
+            int firstRow = it.key() * _pageSize;
+            int numColumns = page.objects.isEmpty() ? 0 : page.values.size() / page.objects.size();
+            int first = qMax(topLeft.row(), firstRow);
+            int last = qMin(bottomRight.row(), firstRow + int(page.objects.size()) - 1);
+            for(int row = first; row <= last && numColumns; ++row) {
+                for(int column = topLeft.column(); column <= bottomRight.column() && column < numColumns; ++column)
+                    page.hasValue.clearBit((row - firstRow) * numColumns + column);
+            }
+        }
+        for(int column = topLeft.column(); column <= bottomRight.column() && column < _valueColumns.size(); ++column) {
+            ValueColumn &valueColumn = _valueColumns[column];
+            QBitArray &dirty = valueColumn.dirty;
+            int lastRow = qMin(bottomRight.row(), int(dirty.size()) - 1);
+            // Dirty cells are not part of the stats until they are re-read.
+            for(int row = topLeft.row(); row <= lastRow && valueColumn.statsValid; ++row) {
+                if(!dirty.testBit(row))
+                    valueColumn.removeFromStats(valueColumn.numericValue(row));
+            }
+            if(topLeft.row() <= lastRow)
+                dirty.fill(true, topLeft.row(), lastRow + 1);
+        }
+    }
+    
+    QVariant QtPropertyTableModel::data(const QModelIndex &index, int role) const
+    {
+        if(_isValueCacheEnabled && !_isReadOnly && index.isValid() && (role == Qt::DisplayRole || role == Qt::EditRole))
+            return cachedValue(index.row(), index.column());
+        return QtAbstractPropertyModel::data(index, role);
+    }
+    
+    void QtPropertyTableModel::storeValues() const
+    {
+        // Read all cells up front so that the live objects are never touched afterwards.
+        // In windowed mode values are instead kept per page as they are first read.
+        if(_objectProvider)
+            return;
+        int numRows = rowCount();
+        int numColumns = columnCount();
+        for(int column = 0; column < numColumns; ++column) {
+            for(int row = 0; row < numRows; ++row)
+                cachedValue(row, column);
+        }
+    }
+    
+    void QtPropertyTableModel::valueStoreRowsInserted(const QModelIndex &parent, int first, int last)
+    {
+        // Cached cells of existing rows are kept, and the inserted cells are read on first access.
+        if(parent.isValid())
+            return;
+        int count = last - first + 1;
+        int numRows = rowCount();
+        for(int column = 0; column < _valueColumns.size(); ++column) {
+            ValueColumn &valueColumn = _valueColumns[column];
+            if(valueColumn.dirty.size() + count == numRows && first <= valueColumn.dirty.size())
+                valueColumn.insertRows(first, count);
+        }
+    }
+    
+    void QtPropertyTableModel::valueStoreRowsRemoved(const QModelIndex &parent, int first, int last)
+    {
+        if(parent.isValid())
+            return;
+        int count = last - first + 1;
+        int numRows = rowCount();
+        for(int column = 0; column < _valueColumns.size(); ++column) {
+            ValueColumn &valueColumn = _valueColumns[column];
+            if(valueColumn.dirty.size() - count == numRows && last < valueColumn.dirty.size())
+                valueColumn.removeRows(first, count);
+        }
+    }
+    
+    void QtPropertyTableModel::clearValueStore() const
+    {
+        _valueColumns.clear();
+        _internedStrings.clear();
+        _internedStringIds.clear();
+        _maxInternedStrings = 4096;
+        for(auto it = _pages.begin(); it != _pages.end(); ++it) {
+            it.value().values.clear();
+            it.value().hasValue.clear();
+        }
+    }
+    
+    void QtPropertyTableModel::setObjectProvider(ObjectProviderFunction provider, int rowCount, int pageSize, int maxPages)
+    {
+        beginResetModel();
+        untrackObjects();
+        clearObjectProvider();
+        _objects.clear();
+        _objectProvider = provider;
+        _providerRowCount = provider ? qMax(0, rowCount) : 0;
+        _pageSize = qMax(1, pageSize);
+        _maxPages = qMax(1, maxPages);
+        // Columns are taken from the first row, which is only looked up once.
+        if(QObject *object = rowObject(0))
+            _providerColumnCount = object->metaObject()->propertyCount() + object->dynamicPropertyNames().size();
+        endResetModel();
+        emit rowCountChanged();
+    }
+    
+    QtPropertyTableModel::Page* QtPropertyTableModel::page(int row) const
+    {
+        if(!_objectProvider || row < 0 || row >= _providerRowCount)
+            return NULL;
+        int pageIndex = row / _pageSize;
+        auto it = _pages.find(pageIndex);
+        if(it != _pages.end()) {
+            if(_recentPages.last() != pageIndex) {
+                _recentPages.removeOne(pageIndex);
+                _recentPages.append(pageIndex);
+            }
+            return &it.value();
+        }
+        while(_pages.size() >= _maxPages)
+            _pages.remove(_recentPages.takeFirst());
+        int firstRow = pageIndex * _pageSize;
+        Page newPage;
+        newPage.objects = _objectProvider(firstRow, qMin(_pageSize, _providerRowCount - firstRow));
+        _recentPages.append(pageIndex);
+        return &_pages.insert(pageIndex, newPage).value();
+    }
+    
+    QVariant QtPropertyTableModel::pageValue(int row, int column) const
+    {
+        Page *rowPage = page(row);
+        if(!rowPage)
+            return QVariant();
+        int numColumns = columnCount();
+        int size = rowPage->objects.size() * numColumns;
+        if(rowPage->values.size() != size) {
+            rowPage->values.fill(QVariant(), size);
+            rowPage->hasValue.fill(false, size);
+        }
+        int i = (row % _pageSize) * numColumns + column;
+        if(i >= size)
+            return QVariant();
+        if(!rowPage->hasValue.testBit(i)) {
+            rowPage->values[i] = propertyValue(createIndex(row, column));
+            rowPage->hasValue.setBit(i);
+        }
+        return rowPage->values.at(i);
+    }
+    
+    QObject* QtPropertyTableModel::rowObject(int row) const
+    {
+        if(_objectProvider) {
+            Page *rowPage = page(row);
+            return rowPage ? rowPage->objects.value(row % _pageSize) : NULL;
+        }
+        return (row >= 0 && row < _objects.size()) ? _objects.at(row) : NULL;
+    }
+    
+    QString QtPropertyTableModel::propertyPathAtIndex(const QModelIndex &index) const
+    {
+        // "row/path.to.child.property"
+        QByteArray pathToPropertyName = (index.column() < propertyNames.size()) ? propertyNames.at(index.column()) : propertyNameAtIndex(index);
+        return QString::number(index.row()) + QString("/") + QString::fromUtf8(pathToPropertyName);
+    }
+    
+    bool QtPropertyTableModel::insertRows(int row, int count, const QModelIndex &parent)
+    {
+        // Only valid if we have an object creator method. Rows have no children.
+        if(!_objectCreator || _isReadOnly || _objectProvider || parent.isValid())
+            return false;
+        if(row < 0 || row > _objects.size() || count <= 0)
+            return false;
+        QObjectList objects;
+        for(int i = 0; i < count; ++i)
+            objects.append(_objectCreator());
+        if(_undoStack && !_isUndoing)
+            pushUndoCommand(new QtPropertyRowsCommand(this, row, objects, true)); // Inserts the objects.
+        else
+            insertObjects(row, objects);
+        return true;
+    }
+    
+    bool QtPropertyTableModel::removeRows(int row, int count, const QModelIndex &parent)
+    {
+        if(row < 0 || count <= 0 || row + count > _objects.size() || _isReadOnly || _objectProvider || parent.isValid())
+            return false;
+        if(_undoStack && !_isUndoing) {
+            // Objects are detached rather than deleted so that the removal can be undone.
+            pushUndoCommand(new QtPropertyRowsCommand(this, row, _objects.mid(row, count), false));
+            return true;
+        }
+        qDeleteAll(takeObjects(row, count));
+        return true;
+    }
+    
+    bool QtPropertyTableModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count, const QModelIndex &destinationParent, int destinationRow)
+    {
+        if(sourceRow < 0 || count <= 0 || sourceRow + count > _objects.size() || _isReadOnly || _objectProvider)
+            return false;
+        if(sourceParent.isValid() || destinationParent.isValid())
+            return false;
+        if(_undoStack && !_isUndoing)
+            pushUndoCommand(new QtPropertyMoveRowsCommand(this, sourceRow, count, destinationRow)); // Moves the objects.
+        else
+            moveObjects(sourceRow, count, destinationRow);
+        return true;
+    }
+    
+    void QtPropertyTableModel::insertObjects(int row, const QObjectList &objects)
+    {
+        if(objects.isEmpty())
+            return;
+        bool columnCountWillAlsoChange = _objects.isEmpty() && propertyNames.isEmpty();
+        int count = objects.size();
+        beginInsertRows(QModelIndex(), row, row + count - 1);
+        for(int i = 0; i < count; ++i)
+            _objects.insert(row + i, objects.at(i));
+        trackObjects(row, count);
+        endInsertRows();
+        if(row + count < _objects.size())
+            reorderChildObjectsToMatchRowOrder(row + count);
+        if(columnCountWillAlsoChange) {
+            beginResetModel();
+            endResetModel();
+        }
+        emit rowCountChanged();
+    }
+    
+    QObjectList QtPropertyTableModel::takeObjects(int row, int count)
+    {
+        count = qMin(count, _objects.size() - row);
+        if(row < 0 || count <= 0)
+            return QObjectList();
+        beginRemoveRows(QModelIndex(), row, row + count - 1);
+        untrackObjects(row, count);
+        QObjectList objects = _objects.mid(row, count);
+        QObjectList::iterator begin = _objects.begin() + row;
+        _objects.erase(begin, begin + count);
+        endRemoveRows();
+        emit rowCountChanged();
+        return objects;
+    }
+    
+    int QtPropertyTableModel::moveObjects(int sourceRow, int count, int destinationRow)
+    {
+        // Returns the row that the first moved object ends up at.
+        beginResetModel();
+        QObjectList objectsToMove;
+        for(int i = sourceRow; i < sourceRow + count; ++i)
+            objectsToMove.append(_objects.takeAt(sourceRow));
+        int firstRow = qMin(destinationRow, _objects.size());
+        for(int i = 0; i < objectsToMove.size(); ++i) {
+            if(destinationRow + i >= _objects.size())
+                _objects.append(objectsToMove.at(i));
+            else
+                _objects.insert(destinationRow + i, objectsToMove.at(i));
+        }
+        endResetModel();
+        reorderChildObjectsToMatchRowOrder(sourceRow <= destinationRow ? sourceRow : destinationRow);
+        emit rowOrderChanged();
+        return firstRow;
+    }
+    
+    void QtPropertyTableModel::trackObjects(int row, int count)
+    {
+        int end = (count < 0) ? _objects.size() : qMin(row + count, int(_objects.size()));
+        for(int i = row; i < end; ++i) {
+            if(QObject *object = _objects.at(i))
+                connect(object, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)), Qt::UniqueConnection);
+        }
+    }
+    
+    void QtPropertyTableModel::untrackObjects(int row, int count)
+    {
+        int end = (count < 0) ? _objects.size() : qMin(row + count, int(_objects.size()));
+        for(int i = row; i < end; ++i) {
+            if(QObject *object = _objects.at(i))
+                disconnect(object, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)));
+        }
+    }
+    
+    void QtPropertyTableModel::objectDestroyed(QObject *object)
+    {
+        // Only the QObject part of object is left, so it is only used as a key.
+        // The row lookup is built once and then serves all objects destroyed before the rows next change
+        // (e.g. deleting many row objects at once is linear rather than quadratic).
+        if(_objectRows.isEmpty()) {
+            for(int i = 0; i < _objects.size(); ++i) {
+                if(_objects.at(i))
+                    _objectRows.insert(_objects.at(i), i);
+            }
+        }
+        foreach(int row, _objectRows.values(object)) {
+            if(row < _objects.size() && _objects.at(row) == object)
+                _objects[row] = NULL;
+        }
+        _objectRows.remove(object);
+        _removeDestroyedRowsTimer.start();
+    }
+    
+    void QtPropertyTableModel::removeDestroyedRows()
+    {
+        // Bottom up so that row numbers of the ranges still to be removed stay valid.
+        bool rowsRemoved = false;
+        int last = _objects.size() - 1;
+        while(last >= 0) {
+            if(_objects.at(last)) {
+                --last;
+                continue;
+            }
+            int first = last;
+            while(first > 0 && !_objects.at(first - 1))
+                --first;
+            beginRemoveRows(QModelIndex(), first, last);
+            QObjectList::iterator begin = _objects.begin() + first;
+            _objects.erase(begin, begin + (last - first + 1));
+            endRemoveRows();
+            rowsRemoved = true;
+            last = first - 1;
+        }
+        if(rowsRemoved)
+            emit rowCountChanged();
+    }
+    
+    void QtPropertyTableModel::reorderChildObjectsToMatchRowOrder(int firstRow)
+    {
+        for(int i = firstRow; i < rowCount(); ++i) {
+            QObject *object = objectAtIndex(createIndex(i, 0));
+            if(object) {
+                QObject *parent = object->parent();
+                if(parent) {
+                    object->setParent(NULL);
+                    object->setParent(parent);
+                }
+            }
+        }
+    }
+
+    static QLineEdit* pooledLineEdit(const QtPropertyDelegate *delegate, QWidget *parent)
+    {
+        QLineEdit *editor = qobject_cast<QLineEdit*>(delegate->takePooledEditor(parent, "QLineEdit"));
+        if(!editor)
+            editor = static_cast<QLineEdit*>(delegate->pooledEditor(new QLineEdit(parent), "QLineEdit"));
+        return editor;
+    }
+    
+    static void setLineEditText(QWidget *editor, const QModelIndex&, const QVariant &value)
+    {
+        if(QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor))
+            lineEditor->setText(valueToText(value));
+    }
+    
+    static QHash<int, QtPropertyTypeHandler> defaultTypeHandlers()
+    {
+        QHash<int, QtPropertyTypeHandler> handlers;
+        
+        // bool: We want a check box, but instead of creating an editor widget we'll just directly
+        // draw the check box in paint() and handle mouse clicks in editorEvent().
+        QtPropertyTypeHandler boolHandler;
+        boolHandler.create = [](const QtPropertyDelegate*, QWidget*, const QStyleOptionViewItem&, const QModelIndex&, const QVariant&) -> QWidget* {
+            // No editor when this cell is double clicked.
+            return NULL;
+        };
+        boolHandler.paint = [](QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index, const QVariant &value) {
+            bool checked = value.toBool();
+            QStyleOptionButton buttonOption;
+            buttonOption.state |= QStyle::State_Active; // Required!
+            buttonOption.state |= ((index.flags() & Qt::ItemIsEditable) ? QStyle::State_Enabled : QStyle::State_ReadOnly);
+            buttonOption.state |= (checked ? QStyle::State_On : QStyle::State_Off);
+            QRect checkBoxRect = QApplication::style()->subElementRect(QStyle::SE_CheckBoxIndicator, &buttonOption); // Only used to get size of native checkbox widget.
+            buttonOption.rect = QStyle::alignedRect(option.direction, Qt::AlignLeft, checkBoxRect.size(), option.rect); // Our checkbox rect.
+            QApplication::style()->drawControl(QStyle::CE_CheckBox, &buttonOption, painter);
+            return true;
+        };
+        boolHandler.hitTest = [](QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index, const QVariant &value) {
+            if(event->type() != QEvent::MouseButtonRelease)
+                return false;
+            QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
+            if(mouseEvent->button() != Qt::LeftButton)
+                return false;
+            // Here, we choose to allow clicks anywhere in the cell to toggle the checkbox.
+            if(!option.rect.contains(mouseEvent->pos()))
+                return false;
+            bool checked = value.toBool();
+            QVariant newValue(!checked); // Toggle model's bool value.
+            bool success = model->setData(index, newValue, Qt::EditRole);
+            // Only the toggled cell needs to be repainted.
+            if(success)
+                emit model->dataChanged(index, index);
+            return success;
+        };
+        handlers.insert(QMetaType::Bool, boolHandler);
+        
+        // double: QLineEdit to enter values with arbitrary precision and scientific notation.
+        QtPropertyTypeHandler doubleHandler;
+        doubleHandler.create = [](const QtPropertyDelegate *delegate, QWidget *parent, const QStyleOptionViewItem&, const QModelIndex&, const QVariant&) -> QWidget* {
+            return pooledLineEdit(delegate, parent);
+        };
+        doubleHandler.setEditorData = [](QWidget *editor, const QModelIndex&, const QVariant &value) {
+            if(QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor))
+                lineEditor->setText(value.toString());
+        };
+        doubleHandler.set = [](QWidget *editor, const QModelIndex&, const QVariant&) {
+            QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
+            if(!lineEditor)
+                return QVariant();
+            bool ok;
+            double dval = lineEditor->text().toDouble(&ok);
+            return ok ? QVariant(dval) : QVariant();
+        };
+        handlers.insert(QMetaType::Double, doubleHandler);
+        
+        // QSize(F), QPoint(F), QRect(F): QLineEdit (see valueToText() and valueFromText() for text formats).
+        QtPropertyTypeHandler geometryHandler;
+        geometryHandler.create = [](const QtPropertyDelegate *delegate, QWidget *parent, const QStyleOptionViewItem&, const QModelIndex&, const QVariant&) -> QWidget* {
+            return pooledLineEdit(delegate, parent);
+        };
+        geometryHandler.setEditorData = setLineEditText;
+        geometryHandler.set = [](QWidget *editor, const QModelIndex&, const QVariant &value) {
+            QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
+            return lineEditor ? valueFromText(lineEditor->text(), value.typeId()) : QVariant();
+        };
+        geometryHandler.format = [](const QVariant &value, const QModelIndex&) {
+            return valueToText(value);
+        };
+        handlers.insert(QMetaType::QSize, geometryHandler);
+        handlers.insert(QMetaType::QSizeF, geometryHandler);
+        handlers.insert(QMetaType::QPoint, geometryHandler);
+        handlers.insert(QMetaType::QPointF, geometryHandler);
+        handlers.insert(QMetaType::QRect, geometryHandler);
+        handlers.insert(QMetaType::QRectF, geometryHandler);
+        
+        // QColor: QLineEdit for text format (r, g, b, a) with a button to pick the color from a dialog,
+        // and rendered with a color swatch.
+        QtPropertyTypeHandler colorHandler;
+        colorHandler.create = [](const QtPropertyDelegate *delegate, QWidget *parent, const QStyleOptionViewItem&, const QModelIndex&, const QVariant&) -> QWidget* {
+            QLineEdit *editor = qobject_cast<QLineEdit*>(delegate->takePooledEditor(parent, "QLineEdit:QColor"));
+            if(!editor) {
+                editor = static_cast<QLineEdit*>(delegate->pooledEditor(new QLineEdit(parent), "QLineEdit:QColor"));
+                QAction *pickAction = editor->addAction(QIcon(), QLineEdit::TrailingPosition);
+                pickAction->setText("...");
+                pickAction->setToolTip("Pick color");
+                QObject::connect(pickAction, &QAction::triggered, editor, [editor]() {
+                    bool ok;
+                    QColor initialColor = valueFromText(editor->text(), QMetaType::QColor, QMetaProperty(), &ok).value<QColor>();
+                    QColor color = QColorDialog::getColor(ok ? initialColor : QColor(Qt::white), editor, "Color", QColorDialog::ShowAlphaChannel);
+                    if(color.isValid())
+                        editor->setText(valueToText(QVariant(color)));
+                });
+            }
+            return editor;
+        };
+        colorHandler.setEditorData = setLineEditText;
+        colorHandler.set = [](QWidget *editor, const QModelIndex&, const QVariant &value) {
+            QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
+            return lineEditor ? valueFromText(lineEditor->text(), value.typeId()) : QVariant();
+        };
+        colorHandler.format = geometryHandler.format;
+        colorHandler.paint = [](QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex&, const QVariant &value) {
+            // Swatches are cached per color and size so that scrolling through many colors does not re-render them.
+            QColor color = value.value<QColor>();
+            int swatchSize = qMax(option.rect.height() - 6, 8);
+            QString key = QString("QtPropertyEditorSwatch:") + QString::number(color.rgba(), 16) + QString(":") + QString::number(swatchSize);
+            QPixmap swatch;
+            if(!QPixmapCache::find(key, &swatch)) {
+                swatch = QPixmap(swatchSize, swatchSize);
+                swatch.fill(Qt::white);
+                QPainter swatchPainter(&swatch);
+                if(color.alpha() < 255) {
+                    // Checkerboard behind translucent colors.
+                    int half = swatchSize / 2;
+                    swatchPainter.fillRect(0, 0, half, half, Qt::lightGray);
+                    swatchPainter.fillRect(half, half, swatchSize - half, swatchSize - half, Qt::lightGray);
+                }
+                swatchPainter.fillRect(swatch.rect(), color);
+                swatchPainter.setPen(Qt::darkGray);
+                swatchPainter.drawRect(swatch.rect().adjusted(0, 0, -1, -1));
+                swatchPainter.end();
+                QPixmapCache::insert(key, swatch);
+            }
+            QStyleOptionViewItem itemOption(option);
+            itemOption.text = valueToText(value);
+            itemOption.features |= QStyleOptionViewItem::HasDisplay | QStyleOptionViewItem::HasDecoration;
+            itemOption.icon = QIcon(swatch);
+            itemOption.decorationSize = swatch.size();
+            QApplication::style()->drawControl(QStyle::CE_ItemViewItem, &itemOption, painter);
+            return true;
+        };
+        handlers.insert(QMetaType::QColor, colorHandler);
+        
+        // Push buttons: We want a push button, but instead of creating an editor widget we'll just directly
+        // draw the button in paint() and handle mouse clicks in editorEvent().
+        QtPropertyTypeHandler pushButtonHandler;
+        pushButtonHandler.create = boolHandler.create;
+        pushButtonHandler.paint = [](QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex&, const QVariant &value) {
+            QAction *action = value.value<QtPushButtonActionWrapper>().action;
+            QStyleOptionButton buttonOption;
+            buttonOption.state = QStyle::State_Active | QStyle::State_Raised;
+            if(action) buttonOption.text = action->text();
+            buttonOption.rect = option.rect;
+            QApplication::style()->drawControl(QStyle::CE_PushButton, &buttonOption, painter);
+            return true;
+        };
+        pushButtonHandler.hitTest = [](QEvent *event, QAbstractItemModel*, const QStyleOptionViewItem &option, const QModelIndex&, const QVariant &value) {
+            if(event->type() != QEvent::MouseButtonRelease)
+                return false;
+            QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
+            if(mouseEvent->button() != Qt::LeftButton)
+                return false;
+            if(!option.rect.contains(mouseEvent->pos()))
+                return false;
+            QAction *action = value.value<QtPushButtonActionWrapper>().action;
+            if(action) action->trigger();
+            return true;
+        };
+        handlers.insert(qMetaTypeId<QtPushButtonActionWrapper>(), pushButtonHandler);
+        
+        return handlers;
+    }
+    
+    // Enums: QComboBox sharing a prebuilt model of the enum's keys, and rendered by key.
+    static const QtPropertyTypeHandler& enumTypeHandler()
+    {
+        static QtPropertyTypeHandler handler;
+        if(!handler.create) {
+            handler.create = [](const QtPropertyDelegate *delegate, QWidget *parent, const QStyleOptionViewItem&, const QModelIndex &index, const QVariant &value) -> QWidget* {
+                const QMetaEnum metaEnum = metaEnumAtIndex(index, value);
+                QByteArray kind = QByteArray("QComboBox:") + QByteArray(metaEnum.scope()) + QByteArray("::") + QByteArray(metaEnum.name());
+                QComboBox *editor = qobject_cast<QComboBox*>(delegate->takePooledEditor(parent, kind));
+                if(!editor) {
+                    editor = static_cast<QComboBox*>(delegate->pooledEditor(new QComboBox(parent), kind));
+                    editor->setModel(delegate->enumKeyModel(metaEnum));
+                }
+                return editor;
+            };
+            handler.setEditorData = [](QWidget *editor, const QModelIndex &index, const QVariant &value) {
+                if(QComboBox *comboBoxEditor = qobject_cast<QComboBox*>(editor))
+                    comboBoxEditor->setCurrentText(QString(metaEnumAtIndex(index, value).valueToKey(value.toInt())));
+            };
+            handler.set = [](QWidget *editor, const QModelIndex &index, const QVariant &value) {
+                QComboBox *comboBoxEditor = qobject_cast<QComboBox*>(editor);
+                if(!comboBoxEditor)
+                    return QVariant();
+                bool ok;
+                int selectedValue = metaEnumAtIndex(index, value).keyToValue(comboBoxEditor->currentText().toLatin1().constData(), &ok);
+                return ok ? QVariant(selectedValue) : QVariant();
+            };
+            handler.format = [](const QVariant &value, const QModelIndex &index) {
+                const QMetaEnum metaEnum = metaEnumAtIndex(index, value);
+                return metaEnum.isValid() ? QString(metaEnum.valueToKey(value.toInt())) : value.toString();
+            };
+        }
+        return handler;
+    }
+    
+    // Flags: list of checkable keys, and rendered as "Key1|Key2".
+    static const QtPropertyTypeHandler& flagTypeHandler()
+    {
+        static QtPropertyTypeHandler handler;
+        if(!handler.create) {
+            handler.create = [](const QtPropertyDelegate *delegate, QWidget *parent, const QStyleOptionViewItem&, const QModelIndex &index, const QVariant &value) -> QWidget* {
+                const QMetaEnum metaEnum = metaEnumAtIndex(index, value);
+                QByteArray kind = QByteArray("QListWidget:") + QByteArray(metaEnum.scope()) + QByteArray("::") + QByteArray(metaEnum.name());
+                QListWidget *editor = qobject_cast<QListWidget*>(delegate->takePooledEditor(parent, kind));
+                if(!editor) {
+                    editor = static_cast<QListWidget*>(delegate->pooledEditor(new QListWidget(parent), kind));
+                    const FlagKeyTable table = flagKeyTable(metaEnum);
+                    for(int i = 0; i < table.masks.size(); ++i) {
+                        QListWidgetItem *item = new QListWidgetItem(table.keys.at(i), editor);
+                        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+                        item->setData(Qt::UserRole, QVariant(table.masks.at(i)));
+                    }
+                }
+                return editor;
+            };
+            handler.setEditorData = [](QWidget *editor, const QModelIndex&, const QVariant &value) {
+                QListWidget *listEditor = qobject_cast<QListWidget*>(editor);
+                if(!listEditor)
+                    return;
+                // Check the flags that are fully set.
+                uint flags = uint(value.toInt());
+                int numItems = listEditor->count();
+                for(int i = 0; i < numItems; ++i) {
+                    QListWidgetItem *item = listEditor->item(i);
+                    uint mask = uint(item->data(Qt::UserRole).toInt());
+                    item->setCheckState((flags & mask) == mask ? Qt::Checked : Qt::Unchecked);
+                }
+            };
+            handler.set = [](QWidget *editor, const QModelIndex&, const QVariant&) {
+                QListWidget *listEditor = qobject_cast<QListWidget*>(editor);
+                if(!listEditor)
+                    return QVariant();
+                // Combine the checked flags.
+                int flags = 0;
+                int numItems = listEditor->count();
+                for(int i = 0; i < numItems; ++i) {
+                    QListWidgetItem *item = listEditor->item(i);
+                    if(item->checkState() == Qt::Checked)
+                        flags |= item->data(Qt::UserRole).toInt();
+                }
+                return QVariant(flags);
+            };
+            handler.format = [](const QVariant &value, const QModelIndex &index) {
+                const QMetaEnum metaEnum = metaEnumAtIndex(index, value);
+                return metaEnum.isValid() ? flagsToText(metaEnum, value.toInt()) : value.toString();
+            };
+        }
+        return handler;
+    }
+    
+    // Handlers are held by shared pointer, so a handler in use is unaffected by the hash growing (e.g. as enum types
+    // are resolved) or by the handler being replaced or unregistered.
+    QHash<int, QSharedPointer<const QtPropertyTypeHandler> >& QtPropertyDelegate::typeHandlers()
+    {
+        static QHash<int, QSharedPointer<const QtPropertyTypeHandler> > handlers = []() {
+            QHash<int, QSharedPointer<const QtPropertyTypeHandler> > sharedHandlers;
+            const QHash<int, QtPropertyTypeHandler> defaultHandlers = defaultTypeHandlers();
+            for(auto it = defaultHandlers.constBegin(); it != defaultHandlers.constEnd(); ++it)
+                sharedHandlers.insert(it.key(), QSharedPointer<const QtPropertyTypeHandler>(new QtPropertyTypeHandler(it.value())));
+            return sharedHandlers;
+        }();
+        return handlers;
+    }
+    
+    QSharedPointer<const QtPropertyTypeHandler> QtPropertyDelegate::typeHandler(const QModelIndex &index, const QVariant &value) const
+    {
+        QHash<int, QSharedPointer<const QtPropertyTypeHandler> > &handlers = typeHandlers();
+        int typeId = value.typeId();
+        auto it = handlers.constFind(typeId);
+        if(it != handlers.constEnd())
+            return it.value();
+        // Each enum and flag type has its own meta type, so the handler is resolved via the property once per type.
+        if(value.metaType().flags() & QMetaType::IsEnumeration) {
+            const QMetaEnum metaEnum = metaEnumAtIndex(index, value);
+            if(metaEnum.isValid()) {
+                QSharedPointer<const QtPropertyTypeHandler> handler(new QtPropertyTypeHandler(metaEnum.isFlag() ? flagTypeHandler() : enumTypeHandler()));
+                handlers.insert(typeId, handler);
+                return handler;
+            }
+        }
+        return QSharedPointer<const QtPropertyTypeHandler>();
+    }
+    
+    QWidget* QtPropertyDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
+    {
+        QVariant value = index.data(Qt::DisplayRole);
+        if(value.isValid()) {
+            QSharedPointer<const QtPropertyTypeHandler> handler = typeHandler(index, value);
+            if(handler && handler->create)
+                return handler->create(this, parent, option, index, value);
+        }
+        // Default editors (e.g. QSpinBox) depend only on the value type.
+        QByteArray kind = QByteArray("default:") + QByteArray::number(value.typeId());
+        if(QWidget *editor = takePooledEditor(parent, kind))
+            return editor;
+        QWidget *editor = QStyledItemDelegate::createEditor(parent, option, index);
+        return editor ? pooledEditor(editor, kind) : NULL;
+    }
+    
+    QWidget* QtPropertyDelegate::takePooledEditor(QWidget *parent, const QByteArray &kind) const
+    {
+        auto it = _editorPool.find(kind);
+        if(it == _editorPool.end())
+            return NULL;
+        // Skip editors that were deleted along with their parent.
+        while(!it.value().isEmpty()) {
+            QWidget *editor = it.value().takeLast();
+            if(editor) {
+                // Pooled editors are shared by all views using this delegate.
+                if(editor->parentWidget() != parent)
+                    editor->setParent(parent);
+                return editor;
+            }
+        }
+        return NULL;
+    }
+    
+    QWidget* QtPropertyDelegate::pooledEditor(QWidget *editor, const QByteArray &kind) const
+    {
+        // Tag editor with its kind so that destroyEditor() knows which pool to return it to.
+        editor->setProperty("qtPropertyEditorKind", QVariant(kind));
+        return editor;
+    }
+    
+    QStringListModel* QtPropertyDelegate::enumKeyModel(const QMetaEnum &metaEnum) const
+    {
+        QByteArray enumName = QByteArray(metaEnum.scope()) + QByteArray("::") + QByteArray(metaEnum.name());
+        QStringListModel *&model = _enumKeyModels[enumName];
+        if(!model) {
+            QStringList keys;
+            int numKeys = metaEnum.keyCount();
+            for(int j = 0; j < numKeys; ++j)
+                keys.append(QString(metaEnum.key(j)));
+            model = new QStringListModel(keys, const_cast<QtPropertyDelegate*>(this));
+        }
+        return model;
+    }
+    
+    void QtPropertyDelegate::destroyEditor(QWidget *editor, const QModelIndex &index) const
+    {
+        if(editor == _applyToSelectionEditor)
+            _applyToSelectionEditor = NULL;
+        QByteArray kind = editor ? editor->property("qtPropertyEditorKind").toByteArray() : QByteArray();
+        if(!kind.isEmpty() && editor->parentWidget()) {
+            QList<QPointer<QWidget> > &pool = _editorPool[kind];
+            pool.removeIf([](const QPointer<QWidget> &pooled) { return pooled.isNull(); });
+            if(pool.size() < MaxPooledEditorsPerKind) {
+                editor->hide();
+                pool.append(editor);
+                return;
+            }
+        }
+        QStyledItemDelegate::destroyEditor(editor, index);
+    }
+    
+    void QtPropertyDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+    {
+        // Also called by the view whenever the value changes while the editor is open.
+        QVariant value = index.data(Qt::DisplayRole);
+        if(value.isValid()) {
+            QSharedPointer<const QtPropertyTypeHandler> handler = typeHandler(index, value);
+            if(handler && handler->setEditorData) {
+                handler->setEditorData(editor, index, value);
+                return;
+            }
+        }
+        QStyledItemDelegate::setEditorData(editor, index);
+    }
+    
+    void QtPropertyDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+    {
+        QVariant value = index.data(Qt::DisplayRole);
+        if(value.isValid()) {
+            QSharedPointer<const QtPropertyTypeHandler> handler = typeHandler(index, value);
+            if(handler && handler->set) {
+                QVariant newValue = handler->set(editor, index, value);
+                if(newValue.isValid())
+                    setModelValue(editor, model, index, newValue);
+                return;
+            }
+        }
+        // Default editors (e.g. QSpinBox) hold their value in their user property.
+        QByteArray userPropertyName = QByteArray(editor->metaObject()->userProperty().name());
+        if(!userPropertyName.isEmpty())
+            setModelValue(editor, model, index, editor->property(userPropertyName.constData()));
+        else
+            QStyledItemDelegate::setModelData(editor, model, index);
+    }
+    
+    // Set cells via a single batch when possible. Returns the number of cells that could not be set.
+    static int setModelValues(QAbstractItemModel *model, const QModelIndexList &indexes, const QVariantList &values)
+    {
+        QModelIndexList failedIndexes;
+        if(QtAbstractPropertyModel *propertyModel = qobject_cast<QtAbstractPropertyModel*>(model)) {
+            propertyModel->setBatchData(indexes, values, &failedIndexes);
+        } else {
+            for(int i = 0; i < indexes.size(); ++i) {
+                if(!model->setData(indexes.at(i), values.at(i), Qt::EditRole))
+                    failedIndexes.append(indexes.at(i));
+            }
+        }
+        return failedIndexes.size();
+    }
+    
+    static int setModelValues(QAbstractItemModel *model, const QModelIndexList &indexes, const QVariant &value)
+    {
+        QVariantList values;
+        values.reserve(indexes.size());
+        for(int i = 0; i < indexes.size(); ++i)
+            values.append(value);
+        return setModelValues(model, indexes, values);
+    }
+    
+    void QtPropertyDelegate::setModelValue(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index, const QVariant &value) const
+    {
+        // Ctrl+Return/Enter applies the edited value to the entire selection (if the edited cell is part of it).
+        // Every other commit (e.g. Return, Tab or focus out) only sets the edited cell.
+        bool applyToSelection = editor && editor == _applyToSelectionEditor;
+        _applyToSelectionEditor = NULL;
+        if(applyToSelection) {
+            QWidget *viewport = editor->parentWidget();
+            QAbstractItemView *view = viewport ? qobject_cast<QAbstractItemView*>(viewport->parentWidget()) : NULL;
+            if(view && view->selectionModel() && view->selectionModel()->isSelected(index)) {
+                QModelIndexList indexes = view->selectionModel()->selectedIndexes();
+                if(indexes.size() > 1) {
+                    int numFailed = setModelValues(model, indexes, value);
+                    if(numFailed)
+                        emit const_cast<QtPropertyDelegate*>(this)->editFailed(numFailed, indexes.size());
+                    return;
+                }
+            }
+        }
+        model->setData(index, value, Qt::EditRole);
+    }
+    
+    bool QtPropertyDelegate::eventFilter(QObject *object, QEvent *event)
+    {
+        // QStyledItemDelegate commits on Return/Enter via a queued call, so remember the editor until that commit.
+        if(event->type() == QEvent::KeyPress) {
+            QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+            bool isEnter = (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter);
+            _applyToSelectionEditor = (isEnter && (keyEvent->modifiers() & Qt::ControlModifier)) ? qobject_cast<QWidget*>(object) : NULL;
+        }
+        return QStyledItemDelegate::eventFilter(object, event);
+    }
+    
+    void QtPropertyDelegate::updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &index) const
+    {
+        if(QListWidget *listEditor = qobject_cast<QListWidget*>(editor)) {
+            // Drop down from the cell far enough to show several flags at once.
+            int numVisibleItems = qMin(listEditor->count(), 8);
+            int height = numVisibleItems * listEditor->sizeHintForRow(0) + 2 * listEditor->frameWidth();
+            int width = qMax(option.rect.width(), listEditor->sizeHintForColumn(0) + 2 * listEditor->frameWidth());
+            listEditor->setGeometry(QRect(option.rect.topLeft(), QSize(width, qMax(height, option.rect.height()))));
+            return;
+        }
+        QStyledItemDelegate::updateEditorGeometry(editor, option, index);
+    }
+    
+    QString QtPropertyDelegate::displayText(const QVariant &value, const QLocale &locale) const
+    {
+        if(value.isValid()) {
+            const QHash<int, QSharedPointer<const QtPropertyTypeHandler> > &handlers = typeHandlers();
+            auto it = handlers.constFind(value.typeId());
+            if(it != handlers.constEnd() && it.value()->format)
+                return it.value()->format(value, QModelIndex());
+        }
+        return QStyledItemDelegate::displayText(value, locale);
+    }
+    
+    void QtPropertyDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+    {
+        if(index.data(QtPropertyTreeModel::MixedValueRole).toBool()) {
+            // Merged objects with differing values.
+            QStyleOptionViewItem itemOption(option);
+            initStyleOption(&itemOption, index);
+            itemOption.text = QString("mixed");
+            itemOption.font.setItalic(true);
+            itemOption.features &= ~QStyleOptionViewItem::HasCheckIndicator;
+            QApplication::style()->drawControl(QStyle::CE_ItemViewItem, &itemOption, painter);
+            return;
+        }
+        QVariant value = index.data(Qt::DisplayRole);
+        if(value.isValid()) {
+            if(QSharedPointer<const QtPropertyTypeHandler> handler = typeHandler(index, value)) {
+                QStyleOptionViewItem itemOption(option);
+                initStyleOption(&itemOption, index);
+                if(handler->paint && handler->paint(painter, itemOption, index, value))
+                    return;
+                if(handler->format) {
+                    // Formatting may depend on the property (e.g. enum keys), which is not available in displayText().
+                    itemOption.text = handler->format(value, index);
+                    QApplication::style()->drawControl(QStyle::CE_ItemViewItem, &itemOption, painter);
+                    return;
+                }
+            }
+        }
+        QStyledItemDelegate::paint(painter, option, index);
+    }
+    
+    bool QtPropertyDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
+    {
+        QVariant value = index.data(Qt::DisplayRole);
+        if(value.isValid()) {
+            QSharedPointer<const QtPropertyTypeHandler> handler = typeHandler(index, value);
+            if(handler && handler->hitTest)
+                return handler->hitTest(event, model, option, index, value);
+        }
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+    
+    /* --------------------------------------------------------------------------------
+     * Incremental parser for delimiter separated text (TSV/CSV with RFC 4180 style quoting).
+     * Text can be fed in chunks of any size (e.g. as it is read from a file by importTable()), and each completed
+     * field is passed on to the callback immediately so that the full text never needs to be split up front.
+     * -------------------------------------------------------------------------------- */
+    class DelimitedTextParser
+    {
+    public:
+        typedef std::function<void(int row, int column, const QString &field)> FieldFunction;
+        
+        DelimitedTextParser(QChar delimiter, FieldFunction fieldFunction) : _delimiter(delimiter), _fieldFunction(fieldFunction) {}
+        
+        int rowsParsed() const { return _row; }
+        
+        void feed(QStringView text)
+        {
+            for(const QChar c : text) {
+                if(_quoteInQuotedField) {
+                    // Either an escaped quote ("") or the end of the quoted field.
+                    _quoteInQuotedField = false;
+                    if(c == QLatin1Char('"')) {
+                        _field += c;
+                        continue;
+                    }
+                    _inQuotes = false;
+                } else if(_inQuotes) {
+                    if(c == QLatin1Char('"'))
+                        _quoteInQuotedField = true;
+                    else
+                        _field += c;
+                    continue;
+                }
+                if(c == QLatin1Char('"') && _field.isEmpty()) {
+                    _inQuotes = true;
+                } else if(c == _delimiter) {
+                    endField();
+                } else if(c == QLatin1Char('\n')) {
+                    endField();
+                    endRow();
+                } else if(c != QLatin1Char('\r')) {
+                    _field += c;
+                }
+            }
+        }
+        
+        void finish()
+        {
+            // Last row without a trailing newline.
+            if(_column > 0 || !_field.isEmpty() || _inQuotes) {
+                endField();
+                endRow();
+            }
+            _inQuotes = _quoteInQuotedField = false;
+        }
+        
+    protected:
+        QChar _delimiter;
+        FieldFunction _fieldFunction;
+        QString _field;
+        int _row = 0;
+        int _column = 0;
+        bool _inQuotes = false;
+        bool _quoteInQuotedField = false;
+        
+        void endField() { _fieldFunction(_row, _column, _field); _field.clear(); ++_column; }
+        void endRow() { _column = 0; ++_row; }
+    };
+    
+    // Quote a field if it contains the delimiter, quotes or line breaks.
+    static QString delimitedTextField(const QString &text, QChar delimiter)
+    {
+        if(!text.contains(delimiter) && !text.contains(QLatin1Char('"')) && !text.contains(QLatin1Char('\n')) && !text.contains(QLatin1Char('\r')))
+            return text;
+        QString quoted = text;
+        quoted.replace(QLatin1String("\""), QLatin1String("\"\""));
+        return QLatin1Char('"') + quoted + QLatin1Char('"');
+    }
+    
+    // Writes rows in chunks so that large tables are never fully buffered as text.
+    // If given, fetchChunk(firstRow) is called before the cells of each chunk are read, and returning false aborts the write.
+    // Columnar format (little endian QDataStream):
+    //   quint32 magic "QPEC", quint32 version, qint32 numColumns, {QString header, quint8 type} per column,
+    //   then chunks of {qint32 numRows, column arrays in column order}, terminated by a chunk with zero rows.
+    //   Doubles are float64 (NaN for missing), ints are int32, bools are packed bits and text is QString.
+    enum ColumnarType : quint8 { DoubleColumn, IntColumn, BoolColumn, TextColumn };
+    
+    static bool writeTable(QIODevice *device, QtPropertyTableModel::ExportFormat format, const QStringList &headers, const QList<QMetaProperty> &metaProperties,
+                           int numRows, const std::function<QVariant(int row, int column)> &cell, int chunkRows,
+                           const std::function<bool(int firstRow)> &fetchChunk = std::function<bool(int)>())
+    {
+        int numColumns = headers.size();
+        chunkRows = qMax(1, chunkRows);
+        if(format == QtPropertyTableModel::CsvExport) {
+            QString text;
+            for(int column = 0; column < numColumns; ++column) {
+                if(column)
+                    text += QLatin1Char(',');
+                text += delimitedTextField(headers.at(column), QLatin1Char(','));
+            }
+            text += QLatin1Char('\n');
+            for(int row = 0; row < numRows; ++row) {
+                if(row % chunkRows == 0 && fetchChunk && !fetchChunk(row))
+                    return false;
+                for(int column = 0; column < numColumns; ++column) {
+                    if(column)
+                        text += QLatin1Char(',');
+                    text += delimitedTextField(valueToText(cell(row, column), metaProperties.at(column)), QLatin1Char(','));
+                }
+                text += QLatin1Char('\n');
+                if((row + 1) % chunkRows == 0 || row + 1 == numRows) {
+                    if(device->write(text.toUtf8()) < 0)
+                        return false;
+                    text.clear();
+                }
+            }
+            if(!text.isEmpty() && device->write(text.toUtf8()) < 0)
+                return false;
+            return true;
+        }
+        QDataStream out(device);
+        out.setVersion(QDataStream::Qt_6_0);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out << quint32(0x51504543) << quint32(1) << qint32(numColumns);
+        // Column types are taken from the first row.
+        if(numRows && fetchChunk && !fetchChunk(0))
+            return false;
+        QVector<ColumnarType> types(numColumns, TextColumn);
+        for(int column = 0; column < numColumns; ++column) {
+            int typeId = numRows ? cell(0, column).typeId() : QMetaType::UnknownType;
+            if(metaProperties.at(column).isEnumType())
+                types[column] = TextColumn;
+            else if(typeId == QMetaType::Double || typeId == QMetaType::Float)
+                types[column] = DoubleColumn;
+            else if(typeId == QMetaType::Int || typeId == QMetaType::Short || typeId == QMetaType::Char)
+                types[column] = IntColumn;
+            else if(typeId == QMetaType::Bool)
+                types[column] = BoolColumn;
+            out << headers.at(column) << quint8(types.at(column));
+        }
+        for(int firstRow = 0; firstRow < numRows; firstRow += chunkRows) {
+            if(firstRow && fetchChunk && !fetchChunk(firstRow))
+                return false;
+            int rows = qMin(chunkRows, numRows - firstRow);
+            out << qint32(rows);
+            for(int column = 0; column < numColumns; ++column) {
+                switch(types.at(column)) {
+                    case DoubleColumn:
+                        for(int row = firstRow; row < firstRow + rows; ++row) {
+                            QVariant value = cell(row, column);
+                            out << (value.isValid() ? value.toDouble() : qQNaN());
+                        }
+                        break;
+                    case IntColumn:
+                        for(int row = firstRow; row < firstRow + rows; ++row)
+                            out << qint32(cell(row, column).toInt());
+                        break;
+                    case BoolColumn: {
+                        QByteArray bits((rows + 7) / 8, 0);
+                        for(int row = firstRow; row < firstRow + rows; ++row) {
+                            if(cell(row, column).toBool())
+                                bits[(row - firstRow) / 8] = char(bits.at((row - firstRow) / 8) | (1 << ((row - firstRow) % 8)));
+                        }
+                        out.writeRawData(bits.constData(), bits.size());
+                        break;
                     }
+                    default:
+                        for(int row = firstRow; row < firstRow + rows; ++row)
+                            out << valueToText(cell(row, column), metaProperties.at(column));
                 }
-                if(propertyHeaders.contains(propertyName))
-                    return QVariant(childPath + propertyHeaders.value(propertyName));
-                return QVariant(childPath + propertyName);
             }
+            if(out.status() != QDataStream::Ok)
+                return false;
         }
-        return QVariant();
+        out << qint32(0);
+        return out.status() == QDataStream::Ok;
     }
     
-    bool QtPropertyTableModel::insertRows(int row, int count, const QModelIndex &parent)
+    void QtPropertyTableModel::exportHeaders(QStringList *headers, QList<QMetaProperty> *metaProperties) const
     {
-        // Only valid if we have an object creator method.
-        if(!_objectCreator)
-            return false;
-        bool columnCountWillAlsoChange = _objects.isEmpty() && propertyNames.isEmpty();
-        beginInsertRows(parent, row, row + count - 1);
-        for(int i = row; i < row + count; ++i) {
-            QObject *object = _objectCreator();
-            _objects.insert(i, object);
-        }
-        endInsertRows();
-        if(row + count < _objects.size())
-            reorderChildObjectsToMatchRowOrder(row + count);
-        if(columnCountWillAlsoChange) {
-            beginResetModel();
-            endResetModel();
+        int numColumns = columnCount();
+        for(int column = 0; column < numColumns; ++column) {
+            headers->append(headerData(column, Qt::Horizontal, Qt::DisplayRole).toString());
+            metaProperties->append(rowCount() ? metaPropertyAtIndex(createIndex(0, column)) : QMetaProperty());
         }
-        emit rowCountChanged();
-        return true;
     }
     
-    bool QtPropertyTableModel::removeRows(int row, int count, const QModelIndex &parent)
+    bool QtPropertyTableModel::exportTable(QIODevice *device, ExportFormat format, int chunkRows) const
     {
-        beginRemoveRows(parent, row, row + count - 1);
-        for(int i = row; i < row + count; ++i)
-            delete _objects.at(i);
-        QObjectList::iterator begin = _objects.begin() + row;
-        _objects.erase(begin, begin + count);
-        endRemoveRows();
-        emit rowCountChanged();
-        return true;
+        if(!device || !device->isWritable())
+            return false;
+        QStringList headers;
+        QList<QMetaProperty> metaProperties;
+        exportHeaders(&headers, &metaProperties);
+        return writeTable(device, format, headers, metaProperties, rowCount(),
+                          [this](int row, int column) { return data(createIndex(row, column), Qt::EditRole); }, chunkRows);
     }
     
-    bool QtPropertyTableModel::moveRows(const QModelIndex &/*sourceParent*/, int sourceRow, int count, const QModelIndex &/*destinationParent*/, int destinationRow)
+    // Chunk of rows requested by a background export from the GUI thread. The worker waits until the chunk is read
+    // or the export is cancelled (because the model is destroyed or the application quits).
+    struct ExportChunkRequest
     {
-        beginResetModel();
-        QObjectList objectsToMove;
-        for(int i = sourceRow; i < sourceRow + count; ++i)
-            objectsToMove.append(_objects.takeAt(sourceRow));
-        for(int i = 0; i < objectsToMove.size(); ++i) {
-            if(destinationRow + i >= _objects.size())
-                _objects.append(objectsToMove.at(i));
-            else
-                _objects.insert(destinationRow + i, objectsToMove.at(i));
-        }
-        endResetModel();
-        reorderChildObjectsToMatchRowOrder(sourceRow <= destinationRow ? sourceRow : destinationRow);
-        emit rowOrderChanged();
-        return true;
-    }
+        QMutex mutex;
+        QWaitCondition condition;
+        QVector<QVariant> values; // Row major.
+        bool isReady = false;
+        bool isCancelled = false;
+        bool success = false;
+        
+        void cancel() { QMutexLocker locker(&mutex); isCancelled = true; condition.wakeAll(); }
+    };
     
-    void QtPropertyTableModel::reorderChildObjectsToMatchRowOrder(int firstRow)
+    void QtPropertyTableModel::exportTableInBackground(const QString &fileName, ExportFormat format, int chunkRows)
     {
-        for(int i = firstRow; i < rowCount(); ++i) {
-            QObject *object = objectAtIndex(createIndex(i, 0));
-            if(object) {
-                QObject *parent = object->parent();
-                if(parent) {
-                    object->setParent(NULL);
-                    object->setParent(parent);
-                }
+        QStringList headers;
+        QList<QMetaProperty> metaProperties;
+        exportHeaders(&headers, &metaProperties);
+        int numRows = rowCount();
+        int numColumns = headers.size();
+        chunkRows = qMax(1, chunkRows);
+        QSharedPointer<ExportChunkRequest> request(new ExportChunkRequest);
+        QtPropertyTableModel *model = this;
+        QThread *thread = QThread::create([=]() {
+            // Objects live in the GUI thread, so the writer requests one chunk of rows at a time from there
+            // and only ever holds that chunk. The model is only ever dereferenced in the GUI thread.
+            int chunkFirstRow = 0;
+            QVector<QVariant> chunk;
+            auto fetchChunk = [&](int firstRow) {
+                int rows = qMin(chunkRows, numRows - firstRow);
+                QMutexLocker locker(&request->mutex);
+                if(request->isCancelled)
+                    return false;
+                request->isReady = false;
+                // The model is the context of the queued read, so the read is dropped if the model is destroyed.
+                // Cancelling takes the mutex, so the model is still alive while it is held here.
+                QMetaObject::invokeMethod(model, [model, request, firstRow, rows, numColumns]() {
+                    QVector<QVariant> values;
+                    values.reserve(rows * numColumns);
+                    for(int row = firstRow; row < firstRow + rows; ++row) {
+                        for(int column = 0; column < numColumns; ++column)
+                            values.append(model->data(model->index(row, column), Qt::EditRole));
+                    }
+                    QMutexLocker locker(&request->mutex);
+                    request->values.swap(values);
+                    request->isReady = true;
+                    request->condition.wakeAll();
+                }, Qt::QueuedConnection);
+                while(!request->isReady && !request->isCancelled)
+                    request->condition.wait(&request->mutex);
+                if(!request->isReady)
+                    return false;
+                chunk.swap(request->values);
+                request->values.clear();
+                chunkFirstRow = firstRow;
+                return true;
+            };
+            auto cell = [&](int row, int column) { return chunk.value((row - chunkFirstRow) * numColumns + column); };
+            QFile file(fileName);
+            bool success = false;
+            if(file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                success = writeTable(&file, format, headers, metaProperties, numRows, cell, chunkRows, fetchChunk);
+                file.close();
             }
-        }
+            QMutexLocker locker(&request->mutex);
+            request->success = success;
+        });
+        // The thread is owned by the model, so it never outlives it. If the model is destroyed (destroyed() is emitted
+        // before children are deleted) or the application quits first, the export is cancelled and waited for.
+        thread->setParent(this);
+        auto cancel = [request, thread]() { request->cancel(); thread->wait(); };
+        connect(this, &QObject::destroyed, thread, cancel);
+        if(QCoreApplication::instance())
+            connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, thread, cancel);
+        connect(thread, &QThread::finished, this, [this, thread, request, fileName]() {
+            bool success;
+            {
+                QMutexLocker locker(&request->mutex);
+                success = request->success;
+            }
+            thread->deleteLater();
+            emit exportFinished(fileName, success);
+        });
+        thread->start();
     }
-
-    QWidget* QtPropertyDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
+    
+    // Property descriptor for an imported column, resolved once from the first created object.
+    struct ImportColumn
     {
-        QVariant value = index.data(Qt::DisplayRole);
-        if(value.isValid()) {
-            if(value.typeId() == QVariant::Bool) {
-                // We want a check box, but instead of creating an editor widget we'll just directly
-                // draw the check box in paint() and handle mouse clicks in editorEvent().
-                // Here, we'll just return NULL to make sure that no editor is created when this cell is double clicked.
-                return NULL;
-            } else if(value.typeId() == QVariant::Double) {
-                // Return a QLineEdit to enter double values with arbitrary precision and scientific notation.
-                QLineEdit *editor = new QLineEdit(parent);
-                editor->setText(value.toString());
-                return editor;
-            } else if(value.typeId() == QVariant::Int) {
-                // We don't need to do anything special for an integer, we'll just use the default QSpinBox.
-                // However, we do need to check if it is an enum. If so, we'll use a QComboBox editor.
-                const QtAbstractPropertyModel *propertyModel = qobject_cast<const QtAbstractPropertyModel*>(index.model());
-                if(propertyModel) {
-                    const QMetaProperty metaProperty = propertyModel->metaPropertyAtIndex(index);
-                    if(metaProperty.isValid() && metaProperty.isEnumType()) {
-                        const QMetaEnum metaEnum = metaProperty.enumerator();
-                        int numKeys = metaEnum.keyCount();
-                        if(numKeys > 0) {
-                            QComboBox *editor = new QComboBox(parent);
-                            for(int j = 0; j < numKeys; ++j) {
-                                QByteArray key = QByteArray(metaEnum.key(j));
-                                editor->addItem(QString(key));
-                            }
-                            QByteArray currentKey = QByteArray(metaEnum.valueToKey(value.toInt()));
-                            editor->setCurrentText(QString(currentKey));
-                            return editor;
-                        }
-                    }
-                }
-            } else if(value.typeId() == QVariant::Size ||
-                       value.typeId() == QVariant::SizeF ||
-                      value.typeId() == QVariant::Point ||
-                       value.typeId() == QVariant::PointF ||
-                      value.typeId() == QVariant::Rect ||
-                       value.typeId() == QVariant::RectF) {
-                // Return a QLineEdit. Parsing will be done in displayText() and setEditorData().
-                QLineEdit *editor = new QLineEdit(parent);
-                editor->setText(displayText(value, QLocale()));
-                return editor;
-            } else if(value.typeId() == QVariant::UserType) {
-                if(value.canConvert<QtPushButtonActionWrapper>()) {
-                    // We want a push button, but instead of creating an editor widget we'll just directly
-                    // draw the button in paint() and handle mouse clicks in editorEvent().
-                    // Here, we'll just return NULL to make sure that no editor is created when this cell is double clicked.
-                    return NULL;
-                }
-            }
+        QByteArray childPath; // Empty for properties of the row object itself.
+        QByteArray propertyName;
+        const QMetaObject *metaObject = NULL; // Of the object owning the property.
+        QMetaProperty metaProperty; // Invalid for dynamic properties.
+        int typeId = QMetaType::UnknownType;
+        
+        bool isValid() const { return !propertyName.isEmpty(); }
+        
+        void write(QObject *rowObject, const QVariant &value) const
+        {
+            QObject *object = childPath.isEmpty() ? rowObject : descendant(rowObject, childPath);
+            if(!object)
+                return;
+            // Objects of the same class share the cached property, otherwise fall back to a lookup by name.
+            if(metaProperty.isValid() && object->metaObject() == metaObject)
+                metaProperty.write(object, value);
+            else
+                object->setProperty(propertyName.constData(), value);
         }
-        return QStyledItemDelegate::createEditor(parent, option, index);
-    }
+    };
     
-    void QtPropertyDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+    static QVector<ImportColumn> importColumns(const QtPropertyTableModel *model, const QStringList &headers, QObject *prototype)
     {
-        QStyledItemDelegate::setEditorData(editor, index);
+        // Headers match either a column header (as shown by the model) or a "path.to.child.property" name.
+        QList<QByteArray> paths = model->propertyNames;
+        if(paths.isEmpty()) {
+            const QMetaObject *metaObject = prototype->metaObject();
+            for(int i = 0; i < metaObject->propertyCount(); ++i)
+                paths.append(QByteArray(metaObject->property(i).name()));
+            paths.append(prototype->dynamicPropertyNames());
+        }
+        QHash<QString, QByteArray> pathsByHeader;
+        foreach(const QByteArray &path, paths) {
+            int pos = path.lastIndexOf('.');
+            QByteArray propertyName = path.mid(pos + 1);
+            pathsByHeader.insert(QString::fromUtf8(path.left(pos + 1)) + model->propertyHeaders.value(propertyName, QString::fromUtf8(propertyName)), path);
+            pathsByHeader.insert(QString::fromUtf8(path), path);
+        }
+        QVector<ImportColumn> columns(headers.size());
+        for(int i = 0; i < headers.size(); ++i) {
+            QByteArray path = pathsByHeader.value(headers.at(i).trimmed());
+            if(path.isEmpty())
+                continue; // Unknown columns are skipped.
+            ImportColumn &column = columns[i];
+            int pos = path.lastIndexOf('.');
+            column.childPath = path.left(qMax(pos, 0));
+            column.propertyName = path.mid(pos + 1);
+            QObject *object = column.childPath.isEmpty() ? prototype : descendant(prototype, column.childPath);
+            if(!object) {
+                column.propertyName.clear();
+                continue;
+            }
+            column.metaObject = object->metaObject();
+            int propertyIndex = column.metaObject->indexOfProperty(column.propertyName.constData());
+            if(propertyIndex >= 0) {
+                column.metaProperty = column.metaObject->property(propertyIndex);
+                if(!column.metaProperty.isWritable()) {
+                    column.propertyName.clear();
+                    continue;
+                }
+                column.typeId = column.metaProperty.userType();
+            } else {
+                column.typeId = object->property(column.propertyName.constData()).typeId();
+            }
+        }
+        return columns;
     }
     
-    void QtPropertyDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+    int QtPropertyTableModel::importTable(QIODevice *device, ExportFormat format, int chunkRows)
     {
-        QVariant value = index.data(Qt::DisplayRole);
-        if(value.isValid()) {
-            if(value.typeId() == QVariant::Double) {
-                // Set model's double value data to numeric representation in QLineEdit editor.
-                // Conversion from text to number handled by QVariant.
-                QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-                if(lineEditor) {
-                    QVariant value = QVariant(lineEditor->text());
-                    bool ok;
-                    double dval = value.toDouble(&ok);
-                    if(ok)
-                        model->setData(index, QVariant(dval), Qt::EditRole);
+        if(!device || !device->isReadable() || !_objectCreator || _isReadOnly || _objectProvider)
+            return -1;
+        chunkRows = qMax(1, chunkRows);
+        int numImportedRows = 0;
+        QObjectList pendingObjects;
+        // Each chunk of rows is a single insertion (and undo step within the import).
+        auto insertPendingObjects = [&]() {
+            if(pendingObjects.isEmpty())
+                return;
+            if(_undoStack && !_isUndoing)
+                pushUndoCommand(new QtPropertyRowsCommand(this, _objects.size(), pendingObjects, true)); // Inserts the objects.
+            else
+                insertObjects(_objects.size(), pendingObjects);
+            numImportedRows += pendingObjects.size();
+            pendingObjects.clear();
+        };
+        bool isUndoMacro = _undoStack && !_isUndoing;
+        if(isUndoMacro)
+            _undoStack->beginMacro("Import Rows");
+        bool success = true;
+        bool isTruncated = false;
+        if(format == CsvExport) {
+            QStringList headers;
+            QVector<ImportColumn> columns;
+            DelimitedTextParser parser(QLatin1Char(','), [&](int row, int column, const QString &field) {
+                if(row == 0) {
+                    headers.append(field);
                     return;
                 }
-            } else if(value.typeId() == QVariant::Int) {
-                // We don't need to do anything special for an integer.
-                // However, if it's an enum we'll set the data based on the QComboBox editor.
-                QComboBox *comboBoxEditor = qobject_cast<QComboBox*>(editor);
-                if(comboBoxEditor) {
-                    QString selectedKey = comboBoxEditor->currentText();
-                    const QtAbstractPropertyModel *propertyModel = qobject_cast<const QtAbstractPropertyModel*>(model);
-                    if(propertyModel) {
-                        const QMetaProperty metaProperty = propertyModel->metaPropertyAtIndex(index);
-                        if(metaProperty.isValid() && metaProperty.isEnumType()) {
-                            const QMetaEnum metaEnum = metaProperty.enumerator();
-                            bool ok;
-                            int selectedValue = metaEnum.keyToValue(selectedKey.toLatin1().constData(), &ok);
-                            if(ok)
-                                model->setData(index, QVariant(selectedValue), Qt::EditRole);
-                            return;
-                        }
-                    }
-                    // If we got here, we have a QComboBox editor but the property at index is not an enum.
+                if(column == 0) {
+                    if(pendingObjects.size() >= chunkRows)
+                        insertPendingObjects();
+                    pendingObjects.append(_objectCreator());
+                    if(row == 1)
+                        columns = importColumns(this, headers, pendingObjects.last());
                 }
-            } else if(value.typeId() == QVariant::Size) {
-                QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-                if(lineEditor) {
-                    // Parse formats: (w x h) or (w,h) or (w h) <== () are optional
-                    QRegularExpression regex("\\s*\\(?\\s*(\\d+)\\s*[x,\\s]\\s*(\\d+)\\s*\\)?\\s*");
-                    QRegularExpressionMatch match = regex.match(lineEditor->text().trimmed());
-                    if(match.hasMatch() && match.capturedTexts().size() == 3) {
-                        bool wok, hok;
-                        int w = match.captured(1).toInt(&wok);
-                        int h = match.captured(2).toInt(&hok);
-                        if(wok && hok)
-                            model->setData(index, QVariant(QSize(w, h)), Qt::EditRole);
-                    }
+                if(column >= columns.size() || !columns.at(column).isValid())
+                    return;
+                const ImportColumn &importColumn = columns.at(column);
+                bool ok;
+                QVariant value = valueFromText(field, importColumn.typeId, importColumn.metaProperty, &ok);
+                if(ok)
+                    importColumn.write(pendingObjects.last(), value);
+            });
+            // The file is decoded and parsed a block at a time.
+            QStringDecoder decoder(QStringDecoder::Utf8);
+            while(!device->atEnd()) {
+                QByteArray bytes = device->read(65536);
+                if(bytes.isEmpty())
+                    break;
+                parser.feed(decoder.decode(bytes));
+            }
+            parser.finish();
+            insertPendingObjects();
+        } else {
+            QDataStream in(device);
+            in.setVersion(QDataStream::Qt_6_0);
+            in.setByteOrder(QDataStream::LittleEndian);
+            quint32 magic, version;
+            qint32 numColumns;
+            in >> magic >> version >> numColumns;
+            // Counts are checked against the bytes left (if known) before anything is allocated for them.
+            auto bytesLeft = [device]() { return device->isSequential() ? std::numeric_limits<qint64>::max() : device->size() - device->pos(); };
+            // Each header is at least a string length and a type byte.
+            if(in.status() != QDataStream::Ok || magic != 0x51504543 || version != 1 || numColumns < 0 || qint64(numColumns) * 5 > bytesLeft()) {
+                success = false;
+            } else {
+                QStringList headers;
+                QVector<quint8> types(numColumns);
+                for(int column = 0; column < numColumns && in.status() == QDataStream::Ok; ++column) {
+                    QString header;
+                    in >> header >> types[column];
+                    headers.append(header);
+                    if(types.at(column) > TextColumn)
+                        in.setStatus(QDataStream::ReadCorruptData);
                 }
-            } else if(value.typeId() == QVariant::SizeF) {
-                QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-                if(lineEditor) {
-                    // Parse formats: (w x h) or (w,h) or (w h) <== () are optional
-                    QRegularExpression regex("\\s*\\(?\\s*([0-9\\+\\-\\.eE]+)\\s*[x,\\s]\\s*([0-9\\+\\-\\.eE]+)\\s*\\)?\\s*");
-                    QRegularExpressionMatch match = regex.match(lineEditor->text().trimmed());
-                    if(match.hasMatch() && match.capturedTexts().size() == 3) {
-                        bool wok, hok;
-                        double w = match.captured(1).toDouble(&wok);
-                        double h = match.captured(2).toDouble(&hok);
-                        if(wok && hok)
-                            model->setData(index, QVariant(QSizeF(w, h)), Qt::EditRole);
+                if(in.status() != QDataStream::Ok)
+                    success = false;
+                QVector<ImportColumn> columns;
+                QVector<QVector<QVariant> > values(numColumns);
+                while(success) {
+                    qint32 rows;
+                    in >> rows;
+                    if(in.status() != QDataStream::Ok || rows <= 0)
+                        break;
+                    // Smallest possible size of the chunk's column arrays (strings are at least their length).
+                    qint64 minChunkBytes = 0;
+                    for(int column = 0; column < numColumns; ++column) {
+                        switch(types.at(column)) {
+                            case DoubleColumn:
+                                minChunkBytes += qint64(rows) * 8;
+                                break;
+                            case BoolColumn:
+                                minChunkBytes += (qint64(rows) + 7) / 8;
+                                break;
+                            default:
+                                minChunkBytes += qint64(rows) * 4;
+                        }
                     }
-                }
-            } else if(value.typeId() == QVariant::Point) {
-                QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-                if(lineEditor) {
-                    // Parse formats: (x,y) or (x y) <== () are optional
-                    QRegularExpression regex("\\s*\\(?\\s*(\\d+)\\s*[x,\\s]\\s*(\\d+)\\s*\\)?\\s*");
-                    QRegularExpressionMatch match = regex.match(lineEditor->text().trimmed());
-                    if(match.hasMatch() && match.capturedTexts().size() == 3) {
-                        bool xok, yok;
-                        int x = match.captured(1).toInt(&xok);
-                        int y = match.captured(2).toInt(&yok);
-                        if(xok && yok)
-                            model->setData(index, QVariant(QPoint(x, y)), Qt::EditRole);
+                    if(minChunkBytes > bytesLeft()) {
+                        isTruncated = true;
+                        break;
                     }
-                }
-            } else if(value.typeId() == QVariant::PointF) {
-                QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-                if(lineEditor) {
-                    // Parse formats: (x,y) or (x y) <== () are optional
-                    QRegularExpression regex("\\s*\\(?\\s*([0-9\\+\\-\\.eE]+)\\s*[x,\\s]\\s*([0-9\\+\\-\\.eE]+)\\s*\\)?\\s*");
-                    QRegularExpressionMatch match = regex.match(lineEditor->text().trimmed());
-                    if(match.hasMatch() && match.capturedTexts().size() == 3) {
-                        bool xok, yok;
-                        double x = match.captured(1).toDouble(&xok);
-                        double y = match.captured(2).toDouble(&yok);
-                        if(xok && yok)
-                            model->setData(index, QVariant(QPointF(x, y)), Qt::EditRole);
+                    // The whole chunk is read before any objects are created for it.
+                    for(int column = 0; column < numColumns; ++column) {
+                        QVector<QVariant> &columnValues = values[column];
+                        columnValues.fill(QVariant(), rows);
+                        switch(types.at(column)) {
+                            case DoubleColumn:
+                                for(int row = 0; row < rows; ++row) {
+                                    double value;
+                                    in >> value;
+                                    if(!qIsNaN(value))
+                                        columnValues[row] = QVariant(value);
+                                }
+                                break;
+                            case IntColumn:
+                                for(int row = 0; row < rows; ++row) {
+                                    qint32 value;
+                                    in >> value;
+                                    columnValues[row] = QVariant(int(value));
+                                }
+                                break;
+                            case BoolColumn: {
+                                QByteArray bits((rows + 7) / 8, 0);
+                                if(in.readRawData(bits.data(), bits.size()) != bits.size())
+                                    in.setStatus(QDataStream::ReadPastEnd);
+                                for(int row = 0; row < rows; ++row)
+                                    columnValues[row] = QVariant(bool(bits.at(row / 8) & (1 << (row % 8))));
+                                break;
+                            }
+                            default:
+                                for(int row = 0; row < rows; ++row) {
+                                    QString text;
+                                    in >> text;
+                                    columnValues[row] = QVariant(text);
+                                }
+                        }
                     }
-                }
-            } else if(value.typeId() == QVariant::Rect) {
-                QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-                if(lineEditor) {
-                    // Parse formats: [Point,Size] or [Point Size] <== [] are optional
-                    // Point formats: (x,y) or (x y) <== () are optional
-                    // Size formats: (w x h) or (w,h) or (w h) <== () are optional
-                    QRegularExpression regex("\\s*\\[?"
-                                             "\\s*\\(?\\s*(\\d+)\\s*[,\\s]\\s*(\\d+)\\s*\\)?\\s*"
-                                             "[,\\s]"
-                                             "\\s*\\(?\\s*(\\d+)\\s*[x,\\s]\\s*(\\d+)\\s*\\)?\\s*"
-                                             "\\]?\\s*");
-                    QRegularExpressionMatch match = regex.match(lineEditor->text().trimmed());
-                    if(match.hasMatch() && match.capturedTexts().size() == 5) {
-                        bool xok, yok, wok, hok;
-                        int x = match.captured(1).toInt(&xok);
-                        int y = match.captured(2).toInt(&yok);
-                        int w = match.captured(3).toInt(&wok);
-                        int h = match.captured(4).toInt(&hok);
-                        if(xok && yok && wok && hok)
-                            model->setData(index, QVariant(QRect(x, y, w, h)), Qt::EditRole);
+                    if(in.status() != QDataStream::Ok) {
+                        isTruncated = true;
+                        break;
                     }
-                }
-            } else if(value.typeId() == QVariant::RectF) {
-                QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-                if(lineEditor) {
-                    // Parse formats: [Point,Size] or [Point Size] <== [] are optional
-                    // Point formats: (x,y) or (x y) <== () are optional
-                    // Size formats: (w x h) or (w,h) or (w h) <== () are optional
-                    QRegularExpression regex("\\s*\\[?"
-                                             "\\s*\\(?\\s*([0-9\\+\\-\\.eE]+)\\s*[,\\s]\\s*([0-9\\+\\-\\.eE]+)\\s*\\)?\\s*"
-                                             "[,\\s]"
-                                             "\\s*\\(?\\s*([0-9\\+\\-\\.eE]+)\\s*[x,\\s]\\s*([0-9\\+\\-\\.eE]+)\\s*\\)?\\s*"
-                                             "\\]?\\s*");
-                    QRegularExpressionMatch match = regex.match(lineEditor->text().trimmed());
-                    if(match.hasMatch() && match.capturedTexts().size() == 5) {
-                        bool xok, yok, wok, hok;
-                        double x = match.captured(1).toDouble(&xok);
-                        double y = match.captured(2).toDouble(&yok);
-                        double w = match.captured(3).toDouble(&wok);
-                        double h = match.captured(4).toDouble(&hok);
-                        if(xok && yok && wok && hok)
-                            model->setData(index, QVariant(QRectF(x, y, w, h)), Qt::EditRole);
+                    for(int row = 0; row < rows; ++row)
+                        pendingObjects.append(_objectCreator());
+                    if(columns.isEmpty())
+                        columns = importColumns(this, headers, pendingObjects.first());
+                    for(int column = 0; column < numColumns; ++column) {
+                        const ImportColumn &importColumn = columns.at(column);
+                        if(!importColumn.isValid())
+                            continue;
+                        const QVector<QVariant> &columnValues = values.at(column);
+                        for(int row = 0; row < rows; ++row) {
+                            QVariant value = columnValues.at(row);
+                            if(types.at(column) == TextColumn) {
+                                // Text is parsed according to the property's type (e.g. enum keys).
+                                bool ok = false;
+                                value = valueFromText(value.toString(), importColumn.typeId, importColumn.metaProperty, &ok);
+                                if(!ok)
+                                    continue;
+                            }
+                            if(value.isValid())
+                                importColumn.write(pendingObjects.at(row), value);
+                        }
                     }
+                    insertPendingObjects();
                 }
-    //        } else if(value.type() == QVariant::Color) {
-    //            QLineEdit *lineEditor = qobject_cast<QLineEdit*>(editor);
-    //            if(lineEditor) {
-    //                // Parse formats: (r,g,b) or (r g b) or (r,g,b,a) or (r g b a) <== () are optional
-    //                QRegularExpression regex("\\s*\\(?"
-    //                                         "\\s*(\\d+)\\s*"
-    //                                         "[,\\s]\\s*(\\d+)\\s*"
-    //                                         "[,\\s]\\s*(\\d+)\\s*"
-    //                                         "([,\\s]\\s*(\\d+)\\s*)?"
-    //                                         "\\)?\\s*");
-    //                QRegularExpressionMatch match = regex.match(lineEditor->text().trimmed());
-    //                if(match.hasMatch() && (match.capturedTexts().size() == 4 || match.capturedTexts().size() == 5)) {
-    //                    bool rok, gok, bok, aok;
-    //                    int r = match.captured(1).toInt(&rok);
-    //                    int g = match.captured(2).toInt(&gok);
-    //                    int b = match.captured(3).toInt(&bok);
-    //                    if(match.capturedTexts().size() == 4) {
-    //                        if(rok && gok && bok)
-    //                            model->setData(index, QColor(r, g, b), Qt::EditRole);
-    //                    } else if(match.capturedTexts().size() == 5) {
-    //                        int a = match.captured(4).toInt(&aok);
-    //                        if(rok && gok && bok && aok)
-    //                            model->setData(index, QColor(r, g, b, a), Qt::EditRole);
-    //                    }
-    //                }
-    //            }
-            }
-        }
-        QStyledItemDelegate::setModelData(editor, model, index);
+            }
+        }
+        if(isUndoMacro)
+            _undoStack->endMacro();
+        // A truncated file still keeps the complete chunks before the point of truncation.
+        if(isTruncated && !numImportedRows)
+            success = false;
+        return success ? numImportedRows : -1;
     }
     
-    QString QtPropertyDelegate::displayText(const QVariant &value, const QLocale &locale) const
+    QtPropertyRefreshScheduler::QtPropertyRefreshScheduler(QAbstractItemView *view) : _view(view)
     {
-        if(value.isValid()) {
-            if(value.typeId() == QVariant::Size) {
-                // w x h
-                QSize size = value.toSize();
-                return QString::number(size.width()) + QString(" x ") + QString::number(size.height());
-            } else if(value.typeId() == QVariant::SizeF) {
-                // w x h
-                QSizeF size = value.toSizeF();
-                return QString::number(size.width()) + QString(" x ") + QString::number(size.height());
-            } else if(value.typeId() == QVariant::Point) {
-                // (x, y)
-                QPoint point = value.toPoint();
-                return QString("(")
-                + QString::number(point.x()) + QString(", ") + QString::number(point.y())
-                + QString(")");
-            } else if(value.typeId() == QVariant::PointF) {
-                // (x, y)
-                QPointF point = value.toPointF();
-                return QString("(")
-                + QString::number(point.x()) + QString(", ") + QString::number(point.y())
-                + QString(")");
-            } else if(value.typeId() == QVariant::Rect) {
-                // [(x, y), w x h]
-                QRect rect = value.toRect();
-                return QString("[(")
-                + QString::number(rect.x()) + QString(", ") + QString::number(rect.y())
-                + QString("), ")
-                + QString::number(rect.width()) + QString(" x ") + QString::number(rect.height())
-                + QString("]");
-            } else if(value.typeId() == QVariant::RectF) {
-                // [(x, y), w x h]
-                QRectF rect = value.toRectF();
-                return QString("[(")
-                + QString::number(rect.x()) + QString(", ") + QString::number(rect.y())
-                + QString("), ")
-                + QString::number(rect.width()) + QString(" x ") + QString::number(rect.height())
-                + QString("]");
-    //        } else if(value.type() == QVariant::Color) {
-    //            // (r, g, b, a)
-    //            QColor color = value.value<QColor>();
-    //            return QString("(")
-    //                    + QString::number(color.red()) + QString(", ") + QString::number(color.green()) + QString(", ")
-    //                    + QString::number(color.blue()) + QString(", ") + QString::number(color.alpha())
-    //                    + QString(")");
-            }
-        }
-        return QStyledItemDelegate::displayText(value, locale);
+        _timer.setSingleShot(true);
+        connect(&_timer, SIGNAL(timeout()), this, SLOT(poll()));
     }
     
-    void QtPropertyDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+    void QtPropertyRefreshScheduler::start()
     {
-        QVariant value = index.data(Qt::DisplayRole);
-        if(value.isValid()) {
-            if(value.typeId() == QVariant::Bool) {
-                bool checked = value.toBool();
-                QStyleOptionButton buttonOption;
-                buttonOption.state |= QStyle::State_Active; // Required!
-                buttonOption.state |= ((index.flags() & Qt::ItemIsEditable) ? QStyle::State_Enabled : QStyle::State_ReadOnly);
-                buttonOption.state |= (checked ? QStyle::State_On : QStyle::State_Off);
-                QRect checkBoxRect = QApplication::style()->subElementRect(QStyle::SE_CheckBoxIndicator, &buttonOption); // Only used to get size of native checkbox widget.
-                buttonOption.rect = QStyle::alignedRect(option.direction, Qt::AlignLeft, checkBoxRect.size(), option.rect); // Our checkbox rect.
-                QApplication::style()->drawControl(QStyle::CE_CheckBox, &buttonOption, painter);
-                return;
-            } else if(value.typeId() == QVariant::Int) {
-                // We don't need to do anything special for an integer.
-                // However, if it's an enum want to render the key name instead of the value.
-                // This cannot be done in displayText() because we need the model index to get the key name.
-                const QtAbstractPropertyModel *propertyModel = qobject_cast<const QtAbstractPropertyModel*>(index.model());
-                if(propertyModel) {
-                    const QMetaProperty metaProperty = propertyModel->metaPropertyAtIndex(index);
-                    if(metaProperty.isValid() && metaProperty.isEnumType()) {
-                        const QMetaEnum metaEnum = metaProperty.enumerator();
-                        QByteArray currentKey = QByteArray(metaEnum.valueToKey(value.toInt()));
-                        QStyleOptionViewItem itemOption(option);
-                        initStyleOption(&itemOption, index);
-                        itemOption.text = QString(currentKey);
-                        QApplication::style()->drawControl(QStyle::CE_ItemViewItem, &itemOption, painter);
-                        return;
-                    }
+        _isActive = true;
+        _currentInterval = _interval;
+        _shownValues.clear();
+        _timer.start(_currentInterval);
+    }
+    
+    void QtPropertyRefreshScheduler::stop()
+    {
+        _isActive = false;
+        _timer.stop();
+        _shownValues.clear();
+    }
+    
+    QModelIndexList QtPropertyRefreshScheduler::visibleIndexes() const
+    {
+        QModelIndexList indexes;
+        QAbstractItemModel *model = _view ? _view->model() : NULL;
+        if(!model || !_view->isVisible())
+            return indexes;
+        QtAbstractPropertyModel *propertyModel = qobject_cast<QtAbstractPropertyModel*>(model);
+        const QRect viewportRect = _view->viewport()->rect();
+        if(QTreeView *tree = qobject_cast<QTreeView*>(_view)) {
+            // Expanded rows from the top of the viewport down.
+            int numColumns = model->columnCount();
+            for(QModelIndex index = tree->indexAt(QPoint(0, 0)); index.isValid(); index = tree->indexBelow(index)) {
+                if(tree->visualRect(index).top() > viewportRect.bottom())
+                    break;
+                for(int column = 0; column < numColumns; ++column) {
+                    if(tree->isColumnHidden(column))
+                        continue;
+                    QModelIndex cell = index.sibling(index.row(), column);
+                    if(!propertyModel || propertyModel->isPropertyValueIndex(cell))
+                        indexes.append(cell);
                 }
-            } else if(value.typeId() == QVariant::UserType) {
-                if(value.canConvert<QtPushButtonActionWrapper>()) {
-                    QAction *action = value.value<QtPushButtonActionWrapper>().action;
-                    QStyleOptionButton buttonOption;
-                    buttonOption.state = QStyle::State_Active | QStyle::State_Raised;
-                    //buttonOption.features = QStyleOptionButton::DefaultButton;
-                    if(action) buttonOption.text = action->text();
-                    buttonOption.rect = option.rect;
-                    //buttonOption.rect = QRect(option.rect.x() + 5, option.rect.y() + 5, option.rect.width() - 10, option.rect.height() - 10);
-                    QApplication::style()->drawControl(QStyle::CE_PushButton, &buttonOption, painter);
-                    return;
+            }
+        } else if(QTableView *table = qobject_cast<QTableView*>(_view)) {
+            int firstRow = table->rowAt(viewportRect.top());
+            int lastRow = table->rowAt(viewportRect.bottom());
+            int firstColumn = table->columnAt(viewportRect.left());
+            int lastColumn = table->columnAt(viewportRect.right());
+            if(firstRow == -1 || firstColumn == -1)
+                return indexes;
+            if(lastRow == -1)
+                lastRow = model->rowCount() - 1;
+            if(lastColumn == -1)
+                lastColumn = model->columnCount() - 1;
+            for(int row = firstRow; row <= lastRow; ++row) {
+                if(table->isRowHidden(row))
+                    continue;
+                for(int column = firstColumn; column <= lastColumn; ++column) {
+                    if(!table->isColumnHidden(column))
+                        indexes.append(model->index(row, column));
                 }
             }
         }
-        QStyledItemDelegate::paint(painter, option, index);
+        return indexes;
     }
     
-    bool QtPropertyDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
+    void QtPropertyRefreshScheduler::refresh()
     {
-        QVariant value = index.data(Qt::DisplayRole);
-        if(value.isValid()) {
-            if(value.typeId() == QVariant::Bool) {
-                if(event->type() == QEvent::MouseButtonDblClick)
-                    return false;
-                if(event->type() != QEvent::MouseButtonRelease)
-                    return false;
-                QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
-                if(mouseEvent->button() != Qt::LeftButton)
-                    return false;
-                //QStyleOptionButton buttonOption;
-                //QRect checkBoxRect = QApplication::style()->subElementRect(QStyle::SE_CheckBoxIndicator, &buttonOption); // Only used to get size of native checkbox widget.
-                //buttonOption.rect = QStyle::alignedRect(option.direction, Qt::AlignLeft, checkBoxRect.size(), option.rect); // Our checkbox rect.
-                // option.rect ==> cell
-                // buttonOption.rect ==> check box
-                // Here, we choose to allow clicks anywhere in the cell to toggle the checkbox.
-                if(!option.rect.contains(mouseEvent->pos()))
-                    return false;
-                bool checked = value.toBool();
-                QVariant newValue(!checked); // Toggle model's bool value.
-                bool success = model->setData(index, newValue, Qt::EditRole);
-                // Update entire table row just in case some other cell also refers to the same bool value.
-                // Otherwise, that other cell will not reflect the current state of the bool set via this cell.
-                if(success)
-                    model->dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), model->columnCount()));
-                return success;
-            } else if(value.typeId() == QVariant::UserType) {
-                if(value.canConvert<QtPushButtonActionWrapper>()) {
-                    QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
-                    if(mouseEvent->button() != Qt::LeftButton)
-                        return false;
-                    if(!option.rect.contains(mouseEvent->pos()))
-                        return false;
-                    QAction *action = value.value<QtPushButtonActionWrapper>().action;
-                    if(action) action->trigger();
-                    return true;
-                }
-            }
+        QAbstractItemModel *model = _view ? _view->model() : NULL;
+        if(!model)
+            return;
+        // Cells seen for the first time were just painted by the view, so they are only recorded.
+        // Cells scrolled out of view are dropped and will be repainted when they scroll back in.
+        // Values are read from the objects (bypassing any value cache, which only sees notified changes).
+        QtAbstractPropertyModel *propertyModel = qobject_cast<QtAbstractPropertyModel*>(model);
+        QModelIndex editIndex = (_view->state() == QAbstractItemView::EditingState) ? _view->currentIndex() : QModelIndex();
+        QHash<QPersistentModelIndex, size_t> shownValues;
+        foreach(const QModelIndex &index, visibleIndexes()) {
+            size_t hash = valueHash(propertyModel ? propertyModel->liveValue(index) : model->data(index, Qt::EditRole));
+            QPersistentModelIndex key(index);
+            auto it = _shownValues.constFind(key);
+            if(it != _shownValues.constEnd() && it.value() != hash && index != editIndex)
+                emit model->dataChanged(index, index, QList<int>() << Qt::DisplayRole << Qt::EditRole);
+            shownValues.insert(key, hash);
         }
-        return QStyledItemDelegate::editorEvent(event, model, option, index);
+        _shownValues.swap(shownValues);
     }
     
-    QtPropertyTreeEditor::QtPropertyTreeEditor(QWidget *parent) : QTreeView(parent)
+    void QtPropertyRefreshScheduler::poll()
+    {
+        if(!_isActive)
+            return;
+        QElapsedTimer elapsed;
+        elapsed.start();
+        refresh();
+        // Back off while over budget and recover gradually once back under it.
+        qint64 msec = elapsed.elapsed();
+        if(msec > _frameBudget)
+            _currentInterval = qMin(_currentInterval * 2, qMax(_interval, 1) * 32);
+        else if(msec < _frameBudget / 2 && _currentInterval > _interval)
+            _currentInterval = qMax(_currentInterval / 2, _interval);
+        _timer.start(_currentInterval);
+    }
+    
+    QtPropertyTreeEditor::QtPropertyTreeEditor(QWidget *parent) : QTreeView(parent), refreshScheduler(this)
     {
         setItemDelegate(&_delegate);
         setAlternatingRowColors(true);
         setModel(&treeModel);
+        connect(&_delegate, SIGNAL(editFailed(int, int)), this, SLOT(reportEditFailure(int, int)));
+    }
+    
+    static void warnEditFailure(QWidget *editor, int numFailed, int numCells)
+    {
+        QMessageBox::warning(editor, "Edit Failed", QString::number(numFailed) + QString(" of ") + QString::number(numCells) + QString(" cells could not be set."));
+    }
+    
+    void QtPropertyTreeEditor::reportEditFailure(int numFailed, int numCells)
+    {
+        emit editFailed(numFailed, numCells);
+        if(_warnOnEditFailure)
+            warnEditFailure(this, numFailed, numCells);
+    }
+    
+    void QtPropertyTreeEditor::keyPressEvent(QKeyEvent *event)
+    {
+        if(event->matches(QKeySequence::Undo) || event->matches(QKeySequence::Redo)) {
+            QtAbstractPropertyModel *propertyModel = qobject_cast<QtAbstractPropertyModel*>(model());
+            if(propertyModel && propertyModel->undoStack()) {
+                if(event->matches(QKeySequence::Undo))
+                    propertyModel->undoStack()->undo();
+                else
+                    propertyModel->undoStack()->redo();
+                return;
+            }
+        }
+        QTreeView::keyPressEvent(event);
     }
     
     void QtPropertyTreeEditor::resizeColumnsToContents()
@@ -947,11 +4335,12 @@ namespace QtPropertyEditor
         resizeColumnToContents(1);
     }
     
-    QtPropertyTableEditor::QtPropertyTableEditor(QWidget *parent) : QTableView(parent)
+    QtPropertyTableEditor::QtPropertyTableEditor(QWidget *parent) : QTableView(parent), refreshScheduler(this)
     {
         setItemDelegate(&_delegate);
         setAlternatingRowColors(true);
         setModel(&tableModel);
+        connect(&_delegate, SIGNAL(editFailed(int, int)), this, SLOT(reportEditFailure(int, int)));
         verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
         setIsDynamic(_isDynamic);
         
@@ -969,6 +4358,73 @@ namespace QtPropertyEditor
         if(QAbstractButton *cornerButton = findChild<QAbstractButton*>()) {
             cornerButton->installEventFilter(this);
         }
+        
+        // Changed only rows.
+        connect(&tableModel, SIGNAL(modelReset()), this, SLOT(updateHiddenRows()));
+        connect(&tableModel, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(updateInsertedHiddenRows(QModelIndex, int, int)));
+        connect(&tableModel, SIGNAL(dataChanged(QModelIndex, QModelIndex, QList<int>)), this, SLOT(updateHiddenRows(QModelIndex, QModelIndex)));
+        
+        // Windowed rows.
+        connect(&tableModel, SIGNAL(modelReset()), this, SLOT(updateRowResizeMode()));
+    }
+    
+    void QtPropertyTableEditor::reportEditFailure(int numFailed, int numCells)
+    {
+        emit editFailed(numFailed, numCells);
+        if(_warnOnEditFailure)
+            warnEditFailure(this, numFailed, numCells);
+    }
+    
+    void QtPropertyTableEditor::updateRowResizeMode()
+    {
+        QtPropertyTableModel *propertyTableModel = qobject_cast<QtPropertyTableModel*>(model());
+        bool isWindowed = propertyTableModel && propertyTableModel->hasObjectProvider();
+        verticalHeader()->setSectionResizeMode(isWindowed ? QHeaderView::Fixed : QHeaderView::ResizeToContents);
+    }
+    
+    void QtPropertyTableEditor::setShowChangedOnly(bool b)
+    {
+        _showChangedOnly = b;
+        if(_showChangedOnly) {
+            updateHiddenRows();
+        } else if(model()) {
+            int numRows = model()->rowCount();
+            for(int row = 0; row < numRows; ++row)
+                setRowHidden(row, false);
+        }
+    }
+    
+    void QtPropertyTableEditor::updateHiddenRows()
+    {
+        if(model())
+            updateHiddenRows(0, model()->rowCount() - 1);
+    }
+    
+    void QtPropertyTableEditor::updateHiddenRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+    {
+        if(topLeft.isValid() && !topLeft.parent().isValid())
+            updateHiddenRows(topLeft.row(), bottomRight.row());
+    }
+    
+    void QtPropertyTableEditor::updateInsertedHiddenRows(const QModelIndex &parent, int first, int last)
+    {
+        if(!parent.isValid())
+            updateHiddenRows(first, last);
+    }
+    
+    void QtPropertyTableEditor::updateHiddenRows(int firstRow, int lastRow)
+    {
+        QAbstractItemModel *propertyModel = model();
+        if(!_showChangedOnly || !propertyModel)
+            return;
+        // A row is shown if any of its cells differ from the baseline (not just the cells in the changed range).
+        int numColumns = propertyModel->columnCount();
+        for(int row = firstRow; row <= lastRow; ++row) {
+            bool isChanged = false;
+            for(int column = 0; column < numColumns && !isChanged; ++column)
+                isChanged = propertyModel->data(propertyModel->index(row, column), QtAbstractPropertyModel::ValueChangedRole).toBool();
+            setRowHidden(row, !isChanged);
+        }
     }
     
     void QtPropertyTableEditor::setIsDynamic(bool b)
@@ -1023,6 +4479,13 @@ namespace QtPropertyEditor
         QModelIndexList indexes = selectionModel()->selectedColumns();
         QMenu *menu = new QMenu;
         menu->addAction("Resize Columns To Contents", this, SLOT(resizeColumnsToContents()));
+        if(QtPropertyTableModel *propertyTableModel = qobject_cast<QtPropertyTableModel*>(model())) {
+            // Column aggregates are shown in the header tooltips.
+            QAction *action = menu->addAction("Show Column Stats");
+            action->setCheckable(true);
+            action->setChecked(propertyTableModel->showColumnStats());
+            connect(action, SIGNAL(toggled(bool)), propertyTableModel, SLOT(setShowColumnStats(bool)));
+        }
         menu->popup(horizontalHeader()->viewport()->mapToGlobal(pos));
     }
     
@@ -1104,9 +4567,143 @@ namespace QtPropertyEditor
         rows = QList<int>::fromVector(vec);
 
 
+        // Deleting the selected rows is a single undo step.
+        QtAbstractPropertyModel *propertyModel = qobject_cast<QtAbstractPropertyModel*>(model());
+        QUndoStack *undoStack = propertyModel ? propertyModel->undoStack() : NULL;
+        if(undoStack)
+            undoStack->beginMacro("Delete Rows");
         for(int i = rows.size() - 1; i >= 0; --i) {
             model()->removeRows(rows.at(i), 1);
         }
+        if(undoStack)
+            undoStack->endMacro();
+    }
+    
+    void QtPropertyTableEditor::applyCurrentValueToSelection()
+    {
+        // Copy the current cell's value to all selected cells in one batch.
+        QModelIndex current = currentIndex();
+        if(!current.isValid())
+            return;
+        QModelIndexList indexes = selectionModel()->selectedIndexes();
+        indexes.removeAll(current);
+        if(indexes.isEmpty())
+            return;
+        int numFailed = setModelValues(model(), indexes, current.data(Qt::EditRole));
+        if(numFailed)
+            reportEditFailure(numFailed, indexes.size());
+    }
+    
+    void QtPropertyTableEditor::copySelection()
+    {
+        // Tab separated text for the bounding rectangle of the selection (unselected cells are left empty).
+        QModelIndexList indexes = selectionModel()->selectedIndexes();
+        if(indexes.isEmpty())
+            return;
+        int top = indexes.first().row(), bottom = top;
+        int left = indexes.first().column(), right = left;
+        foreach(const QModelIndex &index, indexes) {
+            top = qMin(top, index.row());
+            bottom = qMax(bottom, index.row());
+            left = qMin(left, index.column());
+            right = qMax(right, index.column());
+        }
+        // Look up each column's property once (needed to write enums by key).
+        const QtAbstractPropertyModel *propertyModel = qobject_cast<const QtAbstractPropertyModel*>(model());
+        QList<QMetaProperty> metaProperties;
+        for(int column = left; column <= right; ++column)
+            metaProperties.append(propertyModel ? propertyModel->metaPropertyAtIndex(model()->index(top, column)) : QMetaProperty());
+        QString text;
+        for(int row = top; row <= bottom; ++row) {
+            for(int column = left; column <= right; ++column) {
+                if(column > left)
+                    text += QLatin1Char('\t');
+                QModelIndex index = model()->index(row, column);
+                if(selectionModel()->isSelected(index))
+                    text += delimitedTextField(valueToText(index.data(Qt::EditRole), metaProperties.at(column - left)), QLatin1Char('\t'));
+            }
+            text += QLatin1Char('\n');
+        }
+        QApplication::clipboard()->setText(text);
+    }
+    
+    void QtPropertyTableEditor::paste()
+    {
+        // Paste tab or comma separated text starting at the top left selected cell.
+        // A single value is pasted into every selected cell.
+        QString text = QApplication::clipboard()->text();
+        if(text.isEmpty())
+            return;
+        QModelIndexList selectedIndexes = selectionModel()->selectedIndexes();
+        QModelIndex topLeft = currentIndex();
+        foreach(const QModelIndex &index, selectedIndexes) {
+            if(!topLeft.isValid() || index.row() < topLeft.row() || (index.row() == topLeft.row() && index.column() < topLeft.column()))
+                topLeft = index;
+        }
+        if(!topLeft.isValid())
+            return;
+        // Tab separated unless the first line only has commas.
+        QStringView firstLine = QStringView(text).left(text.indexOf(QLatin1Char('\n')));
+        QChar delimiter = (!firstLine.contains(QLatin1Char('\t')) && firstLine.contains(QLatin1Char(','))) ? QLatin1Char(',') : QLatin1Char('\t');
+        const QtAbstractPropertyModel *propertyModel = qobject_cast<const QtAbstractPropertyModel*>(model());
+        int numRows = model()->rowCount();
+        int numColumns = model()->columnCount();
+        // Each column's value type and property are looked up once.
+        QHash<int, QPair<int, QMetaProperty> > columnTypes;
+        QModelIndexList indexes;
+        QVariantList values;
+        int numInvalidValues = 0;
+        int numFields = 0;
+        QString singleField;
+        DelimitedTextParser parser(delimiter, [&](int row, int column, const QString &field) {
+            ++numFields;
+            if(numFields == 1)
+                singleField = field;
+            row += topLeft.row();
+            column += topLeft.column();
+            if(row >= numRows || column >= numColumns)
+                return;
+            QModelIndex index = model()->index(row, column);
+            if(!(index.flags() & Qt::ItemIsEditable))
+                return;
+            auto it = columnTypes.find(column);
+            if(it == columnTypes.end())
+                it = columnTypes.insert(column, QPair<int, QMetaProperty>(index.data(Qt::EditRole).typeId(), propertyModel ? propertyModel->metaPropertyAtIndex(index) : QMetaProperty()));
+            bool ok;
+            QVariant value = valueFromText(field, it.value().first, it.value().second, &ok);
+            if(!ok) {
+                ++numInvalidValues;
+                return;
+            }
+            indexes.append(index);
+            values.append(value);
+        });
+        // The clipboard text is already in memory, so it is fed to the parser at once.
+        parser.feed(text);
+        parser.finish();
+        if(numFields == 1 && selectedIndexes.size() > 1) {
+            // Fill the selection with the single value.
+            indexes.clear();
+            values.clear();
+            numInvalidValues = 0;
+            foreach(const QModelIndex &index, selectedIndexes) {
+                if(!(index.flags() & Qt::ItemIsEditable))
+                    continue;
+                bool ok;
+                QVariant value = valueFromText(singleField, index.data(Qt::EditRole).typeId(), propertyModel ? propertyModel->metaPropertyAtIndex(index) : QMetaProperty(), &ok);
+                if(!ok) {
+                    ++numInvalidValues;
+                    continue;
+                }
+                indexes.append(index);
+                values.append(value);
+            }
+        }
+        if(indexes.isEmpty() && !numInvalidValues)
+            return;
+        int numFailed = setModelValues(model(), indexes, values) + numInvalidValues;
+        if(numFailed)
+            reportEditFailure(numFailed, indexes.size() + numInvalidValues);
     }
     
     void QtPropertyTableEditor::handleSectionMove(int /* logicalIndex */, int oldVisualIndex, int newVisualIndex)
@@ -1125,6 +4722,22 @@ namespace QtPropertyEditor
     
     void QtPropertyTableEditor::keyPressEvent(QKeyEvent *event)
     {
+        if(event->matches(QKeySequence::Copy)) {
+            copySelection();
+            return;
+        } else if(event->matches(QKeySequence::Paste)) {
+            paste();
+            return;
+        } else if(event->matches(QKeySequence::Undo) || event->matches(QKeySequence::Redo)) {
+            QtAbstractPropertyModel *propertyModel = qobject_cast<QtAbstractPropertyModel*>(model());
+            if(propertyModel && propertyModel->undoStack()) {
+                if(event->matches(QKeySequence::Undo))
+                    propertyModel->undoStack()->undo();
+                else
+                    propertyModel->undoStack()->redo();
+                return;
+            }
+        }
         switch(event->key()) {
             case Qt::Key_Backspace:
             case Qt::Key_Delete:
@@ -1136,8 +4749,18 @@ namespace QtPropertyEditor
             case Qt::Key_Plus:
                 appendRow();
                 break;
+            
+            case Qt::Key_Return:
+            case Qt::Key_Enter:
+                if(event->modifiers() & Qt::ControlModifier)
+                    applyCurrentValueToSelection();
+                else
+                    QTableView::keyPressEvent(event);
+                break;
                 
             default:
+                // E.g. navigation, or Undo/Redo without an undo stack for a parent widget to handle.
+                QTableView::keyPressEvent(event);
                 break;
         }
     }
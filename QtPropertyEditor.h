@@ -9,21 +9,33 @@
 #define __QtPropertyEditor_H__
 
 #include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <QAbstractItemModel>
 #include <QAction>
+#include <QBitArray>
 #include <QByteArray>
+#include <QColor>
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QHash>
+#include <QIODevice>
 #include <QList>
+#include <QMap>
 #include <QMetaProperty>
 #include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
+#include <QStringListModel>
 #include <QStyledItemDelegate>
 #include <QTableView>
+#include <QTimer>
 #include <QTreeView>
+#include <QUndoStack>
 #include <QVariant>
 #include <QVBoxLayout>
 
@@ -45,6 +57,16 @@ namespace QtPropertyEditor
     // Get the size of a QTableView widget.
     QSize getTableSize(const QTableView *table);
     
+    // Text representation of property values shared by the delegate, clipboard and file I/O.
+    // Enums are written by key, sizes as "w x h", points as "(x, y)" and rects as "[(x, y), w x h]".
+    QString valueToText(const QVariant &value, const QMetaProperty &metaProperty = QMetaProperty());
+    QVariant valueFromText(const QString &text, int typeId, const QMetaProperty &metaProperty = QMetaProperty(), bool *ok = NULL);
+    
+    // Cheap hash of a property value for change detection.
+    size_t valueHash(const QVariant &value);
+    
+    class QtPropertyUndoCommand;
+    
     /* --------------------------------------------------------------------------------
      * Things that all QObject property models should be able to do.
      * -------------------------------------------------------------------------------- */
@@ -53,7 +75,7 @@ namespace QtPropertyEditor
         Q_OBJECT
         
     public:
-        QtAbstractPropertyModel(QObject *parent = 0) : QAbstractItemModel(parent) {}
+        QtAbstractPropertyModel(QObject *parent = 0);
         
         QList<QByteArray> propertyNames;
         QHash<QByteArray, QString> propertyHeaders;
@@ -66,6 +88,117 @@ namespace QtPropertyEditor
         virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
         virtual bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
         virtual Qt::ItemFlags flags(const QModelIndex &index) const;
+        
+        // Current value of a cell for change polling (see QtPropertyRefreshScheduler), read from the object even
+        // where data() is served from a value cache. In read-only mode this is the stored value.
+        virtual QVariant liveValue(const QModelIndex &index) const { return data(index, Qt::EditRole); }
+        
+        // Set many cells in a single transaction with one dataChanged range per contiguous run of rows in each column.
+        // Cells that could not be set are appended to failedIndexes.
+        bool setBatchData(const QModelIndexList &indexes, const QVariantList &values, QModelIndexList *failedIndexes = NULL);
+        bool setBatchData(const QModelIndexList &indexes, const QVariant &value, QModelIndexList *failedIndexes = NULL);
+        
+        // Optional undo/redo of edits made via the model (the undo stack is NOT owned by the model).
+        // Edits are recorded as (object, property, old value, new value) and consecutive edits to the same cell are merged.
+        // When the recorded history exceeds the byte budget the oldest edits are dropped.
+        QUndoStack* undoStack() const { return _undoStack; }
+        void setUndoStack(QUndoStack *undoStack) { _undoStack = undoStack; }
+        qint64 undoByteBudget() const { return _undoByteBudget; }
+        void setUndoByteBudget(qint64 bytes) { _undoByteBudget = bytes; trimUndoHistory(); }
+        
+        // Save/restore the values of all writable properties shown in the model (e.g. for presets or crash recovery).
+        // Values are keyed by propertyPathAtIndex() and enums are stored by key.
+        // The binary format is streamed record by record, JSON is human readable.
+        enum SnapshotFormat { BinarySnapshot, JsonSnapshot };
+        bool saveSnapshot(QIODevice *device, SnapshotFormat format = BinarySnapshot) const;
+        bool restoreSnapshot(QIODevice *device, SnapshotFormat format = BinarySnapshot);
+        
+        // Stable key for a property value cell (e.g. "child.myInt").
+        virtual QString propertyPathAtIndex(const QModelIndex &index) const { return QString::fromUtf8(propertyNameAtIndex(index)); }
+        
+        // Cells that hold property values (e.g. excludes the tree model's name column).
+        virtual bool isPropertyValueIndex(const QModelIndex &index) const { return !propertyNameAtIndex(index).isEmpty(); }
+        void forEachPropertyValueIndex(const std::function<void(const QModelIndex &index)> &func, const QModelIndex &parent = QModelIndex()) const;
+        
+        // Cells whose value can be written back to the object. Unlike flags(), this excludes read-only values
+        // that are only marked editable for their in-place widgets (e.g. push buttons).
+        virtual bool isWritableIndex(const QModelIndex &index) const;
+        
+        // Diff mode: values are compared against a baseline captured either from this model (before/after)
+        // or from another model (e.g. a second object with the same properties). Cells are matched by
+        // propertyPathAtIndex() and compared by value hash. Changed cells are flagged by ValueChangedRole
+        // and highlighted via Qt::BackgroundRole. The result is cached per cell until the cell's dataChanged
+        // (or a row/layout change), so values changed without any notification are not re-evaluated.
+        enum { ValueChangedRole = Qt::UserRole + 1 };
+        QColor changedBackground = QColor(255, 230, 150);
+        bool hasBaseline() const { return _hasBaseline; }
+        bool isChangedFromBaseline(const QModelIndex &index) const;
+        
+        // Read-only mode: property values are copied into a value store once (and again on refreshValues(), a reset
+        // or a layout change; inserted rows are added and removed rows dropped) and data() is served from the store
+        // without reading the live objects.
+        // All cells are non-editable.
+        bool isReadOnly() const { return _isReadOnly; }
+        
+    public slots:
+        void setReadOnly(bool b);
+        void refreshValues();
+        void captureBaseline() { captureBaseline(this); }
+        void captureBaseline(const QtAbstractPropertyModel *model);
+        void clearBaseline();
+        
+    protected slots:
+        void invalidateValueStore() { _isValueStoreValid = false; clearValueStore(); }
+        
+        // Inserted or removed rows invalidate the whole value store, unless a model shifts its stored values instead.
+        virtual void valueStoreRowsInserted(const QModelIndex &parent, int first, int last) { Q_UNUSED(parent); Q_UNUSED(first); Q_UNUSED(last); invalidateValueStore(); }
+        virtual void valueStoreRowsRemoved(const QModelIndex &parent, int first, int last) { Q_UNUSED(parent); Q_UNUSED(first); Q_UNUSED(last); invalidateValueStore(); }
+        
+        void invalidateChangedCells(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+        void clearChangedCells() { _changedCells.clear(); }
+        
+    protected:
+        friend class QtPropertyUndoCommand;
+        friend class QtPropertyValueCommand;
+        
+        QPointer<QUndoStack> _undoStack;
+        qint64 _undoByteBudget = 16 * 1024 * 1024;
+        qint64 _undoBytes = 0;
+        QList<QtPropertyUndoCommand*> _undoCommands; // Oldest first.
+        bool _isUndoing = false;
+        QHash<QString, size_t> _baseline; // Value hash by property path.
+        bool _hasBaseline = false;
+        
+        // Cached isChangedFromBaseline() by cell identity, so the path is only built on first evaluation.
+        struct CellKey
+        {
+            quintptr internalId;
+            int row;
+            int column;
+            bool operator==(const CellKey &other) const { return internalId == other.internalId && row == other.row && column == other.column; }
+            friend size_t qHash(const CellKey &key, size_t seed = 0) { return qHashMulti(seed, key.internalId, key.row, key.column); }
+        };
+        mutable QHash<CellKey, bool> _changedCells;
+        bool _isReadOnly = false;
+        mutable bool _isValueStoreValid = false;
+        
+        // Read-only value store (built on first access).
+        virtual void storeValues() const {}
+        virtual void clearValueStore() const {}
+        virtual QVariant storedValue(const QModelIndex &index) const { Q_UNUSED(index); return QVariant(); }
+        QVariant valueFromStore(const QModelIndex &index) const;
+        
+        // Live value read from the object.
+        QVariant propertyValue(const QModelIndex &index) const;
+        
+        QVariant baselineData(const QModelIndex &index, int role) const;
+        virtual void baselineChanged();
+        
+        // One dataChanged per contiguous run of rows in each (parent, column) of the cells.
+        void emitDataChanged(const QModelIndexList &indexes);
+        bool writeProperty(const QModelIndex &index, QObject *object, const QByteArray &propertyName, const QVariant &value);
+        void pushUndoCommand(QtPropertyUndoCommand *command);
+        void trimUndoHistory();
     };
     
     /* --------------------------------------------------------------------------------
@@ -77,36 +210,113 @@ namespace QtPropertyEditor
         Q_OBJECT
         
     public:
-        // Internal tree node.
+        // Order of an object's child objects in the tree.
+        enum ChildOrder { ClassGroupedOrder, CreationOrder, ObjectNameOrder, CustomOrder };
+        typedef std::function<bool(const QObject *a, const QObject *b)> ChildLessThanFunction;
+        static QObjectList orderedChildObjects(const QObject *object, ChildOrder order, const ChildLessThanFunction &lessThan = ChildLessThanFunction());
+        
+        // Property rows of an object node. The same (immutable) rows are shared by all object nodes of a class,
+        // unless the rows are filtered or the object has dynamic properties.
+        struct PropertyTemplate
+        {
+            QList<QByteArray> names;
+            QList<QMetaType> types; // Declared types (invalid for dynamic properties, whose current value determines the type).
+        };
+        
+        // Internal tree node for objects, class groups and expanded values.
+        // Property rows of an object node are not nodes: their indexes refer to the object node and the row
+        // (see index()). Only a property whose value is expanded (gadget fields, container elements or a referenced object)
+        // gets a node, when it is first expanded.
         struct Node
         {
             // Node traversal.
             Node *parent = NULL;
-            QList<Node*> children;
+            QList<Node*> children; // Child object (or class group) nodes follow the property rows.
             
             // Node data.
             QObject *object = NULL;
             QByteArray propertyName;
+            mutable int valueIndex = -1; // Into the read-only value store (objectName followed by the property values).
+            const QMetaObject *groupClass = NULL; // Set for class group nodes, whose children are the objects of that class.
+            const QMetaObject *fieldOf = NULL; // Set for fields of a Q_GADGET value (the parent node's value).
+            int fieldIndex = -1; // Property index of the field in fieldOf.
+            bool isContainer = false; // Set for sequential container values, whose element nodes are fetched on demand.
+            int elementIndex = -1; // Set for elements of a sequential container value (the parent node's value).
+            bool isReference = false; // Set for QObject* values, whose referenced object node is added on demand.
+            int propertyRow = -1; // Set for expanded property nodes (row of the property in the parent object node).
+            
+            // Object nodes.
+            QSharedPointer<const PropertyTemplate> properties;
+            QHash<int, Node*> propertyNodes; // Expanded property nodes by row.
             
             Node(Node *parent = NULL) : parent(parent) {}
-            ~Node() { qDeleteAll(children); }
+            ~Node() { clearChildren(); }
+            
+            void clearChildren();
+            int numPropertyRows() const { return properties ? int(properties->names.size()) : 0; }
             
-            void setObject(QObject *object, int maxChildDepth = -1, const QList<QByteArray> &propertyNames = QList<QByteArray>());
+            // Return false to skip an object's property (objects left without properties or children are also skipped).
+            typedef std::function<bool(const Node *objectNode, const QByteArray &propertyName)> PropertyFilter;
+            
+            // "child.grandchild.property" relative to the root object. Objects are identified by objectName, or else by
+            // class name, with the index among same named siblings of the same class appended (e.g. "QObject[1]")
+            // for unnamed objects and names that are not unique.
+            QString path() const;
+            QString pathSegment() const;
         };
         
-        QtPropertyTreeModel(QObject *parent = NULL) : QtAbstractPropertyModel(parent) {}
+        QtPropertyTreeModel(QObject *parent = NULL);
+        
+        // Merged mode: setObjects() with more than one object shows only the (non-child object) properties
+        // common to all of them. Values that differ between objects are flagged by MixedValueRole and shown as "mixed",
+        // and an edit is written to every object as a single undo step. The tree is built from the first object.
+        enum { MixedValueRole = Qt::UserRole + 2 };
+        bool isMerged() const { return _objects.size() > 1 && !_hasMultipleRoots; }
+        bool isMixedValue(const QModelIndex &index) const;
+        
+        // Multiple roots: setRootObjects() shows each object as a top-level object node (object() is then NULL).
+        bool hasMultipleRoots() const { return _hasMultipleRoots; }
+        void setRootObjects(const QObjectList &objects);
         
         // Getters.
         QObject* object() const { return _root.object; }
+        QObjectList objects() const { return _objects; }
         int maxDepth() const { return _maxTreeDepth; }
+        bool showChangedOnly() const { return _showChangedOnly; }
+        ChildOrder childOrder() const { return _childOrder; }
+        bool showClassGroups() const { return _showClassGroups; }
+        bool expandGadgets() const { return _expandGadgets; }
+        bool expandContainers() const { return _expandContainers; }
+        int containerFetchSize() const { return _containerFetchSize; }
+        bool expandReferences() const { return _expandReferences; }
         
         // Setters.
-        void setObject(QObject *object) { beginResetModel(); _root.setObject(object, _maxTreeDepth, propertyNames); endResetModel(); }
+        void setObject(QObject *object) { setObjects(object ? QObjectList() << object : QObjectList()); }
+        void setObjects(const QObjectList &objects);
         void setMaxDepth(int i) { beginResetModel(); _maxTreeDepth = i; reset(); endResetModel(); }
+        void setChildOrder(ChildOrder order) { _childOrder = order; reset(); }
+        void setChildLessThan(ChildLessThanFunction lessThan) { _childLessThan = lessThan; _childOrder = CustomOrder; reset(); }
+        
+        // Child objects are placed under collapsible nodes for each class (ordered by class name).
+        void setShowClassGroups(bool b) { _showClassGroups = b; reset(); }
+        
+        // Properties with Q_GADGET values (and gadget fields of those) are expanded into a child node per field.
+        // An edited field is patched into the property's value, which is then written back as a whole.
+        void setExpandGadgets(bool b) { _expandGadgets = b; reset(); }
+        
+        // Sequential container values (QList, QVector, QVariantList, ...) are expanded into a child node per element.
+        // Element nodes are fetched as the view needs them, containerFetchSize() at a time, and only those elements are read.
+        // Element edits are collected and written back once per container when control returns to the event loop.
+        void setExpandContainers(bool b) { _expandContainers = b; reset(); }
+        void setContainerFetchSize(int i) { _containerFetchSize = qMax(1, i); }
+        
+        // QObject* properties that reference other (non-child) objects can be expanded to the referenced object's properties.
+        // The referenced object is only resolved when expanded, and objects already on the path from the root are not expanded again.
+        void setExpandReferences(bool b) { _expandReferences = b; reset(); }
         void setProperties(const QString &str) { beginResetModel(); QtAbstractPropertyModel::setProperties(str); reset(); endResetModel(); }
         void addProperty(const QString &str) { beginResetModel(); QtAbstractPropertyModel::addProperty(str); reset(); endResetModel(); }
         
-        // Model interface.
+        // Model interface. nodeAtIndex() is NULL for property rows whose value has not been expanded.
         Node* nodeAtIndex(const QModelIndex &index) const;
         QObject* objectAtIndex(const QModelIndex &index) const;
         QByteArray propertyNameAtIndex(const QModelIndex &index) const;
@@ -118,13 +328,108 @@ namespace QtPropertyEditor
         bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
         Qt::ItemFlags flags(const QModelIndex &index) const;
         QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+        bool hasChildren(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+        bool canFetchMore(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+        void fetchMore(const QModelIndex &parent) Q_DECL_OVERRIDE;
+        QString propertyPathAtIndex(const QModelIndex &index) const;
+        bool isPropertyValueIndex(const QModelIndex &index) const;
+        bool isWritableIndex(const QModelIndex &index) const;
         
     public slots:
-        void reset() { setObject(object()); }
+        void reset() { if(_hasMultipleRoots) setRootObjects(objects()); else setObjects(objects()); }
+        
+        // Only build nodes for properties that differ from the baseline (rebuilds the tree).
+        void setShowChangedOnly(bool b) { _showChangedOnly = b; reset(); }
+        
+    protected slots:
+        void objectDestroyed(QObject *object);
+        void syncPendingChildObjects();
+        void writePendingElements();
+        void updateMixedValues(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+        void refreshReferenceNodes(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+        void valueStoreRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
         
     protected:
         Node _root;
+        QObjectList _objects;
+        bool _hasMultipleRoots = false;
         int _maxTreeDepth = -1;
+        bool _showChangedOnly = false;
+        ChildOrder _childOrder = ClassGroupedOrder;
+        ChildLessThanFunction _childLessThan;
+        bool _showClassGroups = false;
+        bool _expandGadgets = true;
+        bool _expandContainers = true;
+        int _containerFetchSize = 256;
+        bool _expandReferences = true;
+        
+        // Indexes of property rows hold their object node tagged in the lowest bit of the internal id (nodes are aligned).
+        static Node* propertyRowObjectNode(const QModelIndex &index) { return (index.internalId() & 1) ? reinterpret_cast<Node*>(index.internalId() & ~quintptr(1)) : NULL; }
+        QModelIndex propertyRowIndex(const Node *objectNode, int row, int column) const { return createIndex(row, column, quintptr(objectNode) | 1); }
+        
+        // Property templates by class, which expire along with the last node that uses them.
+        QHash<const QMetaObject*, QWeakPointer<const PropertyTemplate> > _propertyTemplates;
+        QSharedPointer<const PropertyTemplate> propertyTemplate(const Node *objectNode, const Node::PropertyFilter &filter);
+        void setNodeObject(Node *node, QObject *object, int maxChildDepth = -1, const Node::PropertyFilter &filter = Node::PropertyFilter());
+        
+        // Expandable values.
+        enum ValueKind { PlainValue, GadgetValue, ContainerValue, ReferenceValue };
+        ValueKind valueKind(QMetaType metaType) const;
+        QMetaType propertyType(const Node *objectNode, int row) const;
+        Node* propertyNode(Node *objectNode, int row);
+        void addFieldNodes(Node *node, const QMetaObject *gadget);
+        QVariant nodeValue(const Node *node) const;
+        bool setNodeValue(const Node *node, const QVariant &value);
+        bool setFieldValue(const Node *node, const QVariant &value);
+        bool isWritableValueNode(const Node *node) const;
+        static int containerSize(const QVariant &container);
+        QObject* referenceTarget(const QVariant &value, const Node *parentNode) const;
+        void refreshReferenceNode(Node *node);
+        
+        // Element edits not yet written back, by container value index.
+        QHash<QPersistentModelIndex, QMap<int, QVariant> > _pendingElements;
+        QTimer _elementWriteTimer;
+        QVariant pendingElement(const Node *node) const;
+        
+        // Merged property rows (the root object's properties).
+        bool isMergedPropertyIndex(const QModelIndex &index) const { return isMerged() && propertyRowObjectNode(index) == &_root; }
+        
+        // Mixed value flags by merged property row, computed in setObjects() and updated for edited or changed rows.
+        QBitArray _mixedValues;
+        void updateMixedValues(int firstRow, int lastRow);
+        
+        Node::PropertyFilter propertyFilter() const;
+        void baselineChanged() Q_DECL_OVERRIDE;
+        
+        // Object nodes are kept in sync with their objects: child objects that are added are inserted (deferred until
+        // the event loop so that they are fully constructed), and removed or destroyed objects are removed immediately.
+        QMultiHash<QObject*, Node*> _objectNodes;
+        QList<QPointer<QObject> > _pendingChildSyncs;
+        QTimer _childSyncTimer;
+        
+        QModelIndex indexOfNode(const Node *node) const;
+        void trackObjectNode(Node *node);
+        void untrackObjectNode(Node *node);
+        void untrackObjects();
+        void removeObjectNode(Node *node);
+        Node* childObjectNode(Node *node, QObject *child) const;
+        void syncChildObjects(Node *node);
+        static int classGroupRow(const Node *node, const QMetaObject *groupClass);
+        bool eventFilter(QObject *watched, QEvent *event) Q_DECL_OVERRIDE;
+        
+        // Read-only values of each object node (see Node::valueIndex). Object nodes that are inserted later (e.g. added
+        // children or expanded references) are appended, and the values of removed nodes are dropped, leaving a gap
+        // until the gaps make up half of the store and it is compacted.
+        mutable QVector<QVariant> _storedValues;
+        mutable int _numDroppedValues = 0;
+        QVariant storedNodeValue(const Node *node) const;
+        void storeNodeValues(const Node *node) const;
+        void dropNodeValues(const Node *node) const;
+        void storeValues() const Q_DECL_OVERRIDE;
+        void clearValueStore() const Q_DECL_OVERRIDE { _storedValues.clear(); _numDroppedValues = 0; }
+        void valueStoreRowsInserted(const QModelIndex &parent, int first, int last) Q_DECL_OVERRIDE;
+        void valueStoreRowsRemoved(const QModelIndex &parent, int first, int last) Q_DECL_OVERRIDE;
+        QVariant storedValue(const QModelIndex &index) const Q_DECL_OVERRIDE;
     };
     
     /* --------------------------------------------------------------------------------
@@ -136,15 +441,71 @@ namespace QtPropertyEditor
         
     public:
         typedef std::function<QObject*()> ObjectCreatorFunction;
+        typedef std::function<QObjectList(int firstRow, int count)> ObjectProviderFunction;
+        
+        // Aggregates for a numeric (int, double, etc.) property column.
+        struct ColumnStats
+        {
+            int count = 0;
+            double min = 0;
+            double max = 0;
+            double sum = 0;
+            
+            double mean() const { return count ? sum / count : 0; }
+        };
         
-        QtPropertyTableModel(QObject *parent = NULL) : QtAbstractPropertyModel(parent) {}
+        QtPropertyTableModel(QObject *parent = NULL);
         
         // Getters.
         QObjectList objects() const { return _objects; }
         ObjectCreatorFunction objectCreator() const { return _objectCreator; }
+        bool showColumnStats() const { return _showColumnStats; }
+        
+        // With the value cache enabled (or in read-only mode), column aggregates are kept with the column's cached values
+        // (see the value cache below) and updated cell by cell as values are re-read, so like the cached values they only
+        // reflect changes that were notified. They are only recomputed in full after the current min or max was replaced
+        // or removed. Without the cache they are computed from the live values on each request.
+        // In windowed mode they only cover the rows of the pages currently held (reading every row would pull all pages
+        // through the provider and evict the window), and are computed from those on each request.
+        bool isNumericColumn(int column) const;
+        ColumnStats columnStats(int column) const;
+        
+        // Optional cache of cell values stored per column in typed contiguous arrays (double, int, a bool bitset,
+        // interned string ids, or QVariant for any other type) with a dirty bit per cell. Dirty cells are re-read
+        // from their objects on next access. Cells are dirtied by setData() and dataChanged() notifications (for properties
+        // without NOTIFY signals, e.g. from a QtPropertyRefreshScheduler), inserted and removed rows are shifted in or out,
+        // and the whole cache is discarded on reset, moved rows or changed columns.
+        // The cache also backs read-only mode and the column stats.
+        bool isValueCacheEnabled() const { return _isValueCacheEnabled; }
+        void setValueCacheEnabled(bool b) { _isValueCacheEnabled = b; invalidateValueStore(); }
+        QVariant cachedValue(int row, int column) const;
+        
+        // Export all rows as CSV text or a chunked binary columnar format, written chunkRows rows at a time.
+        // The background export writes the file in a worker thread, which has each chunk of rows read in the GUI thread
+        // as it gets to it (so the event loop must keep running), and emits exportFinished() when done.
+        // Rows that change during the export are written as they are when their chunk is read.
+        // If the model is destroyed or the application quits first, the export is cancelled and its thread waited for.
+        enum ExportFormat { CsvExport, ColumnarExport };
+        bool exportTable(QIODevice *device, ExportFormat format = CsvExport, int chunkRows = 4096) const;
+        void exportTableInBackground(const QString &fileName, ExportFormat format = CsvExport, int chunkRows = 4096);
+        
+        // Append rows read from a file written by exportTable(). Objects are created with objectCreator() and columns
+        // are matched to properties by header, which are looked up once. Rows are inserted a chunk at a time
+        // (one chunk per file chunk for the columnar format). Returns the number of imported rows or -1 on error.
+        // A columnar chunk is read in full before its objects are created, and counts are checked against the size
+        // of the device (unless it is sequential). If the file is truncated, the complete chunks before the point of
+        // truncation are kept and their number of rows is returned (-1 if not even one chunk could be read).
+        int importTable(QIODevice *device, ExportFormat format = CsvExport, int chunkRows = 4096);
+        
+        // Windowed mode for very long lists: rows are pulled from a provider a page at a time and only the most recently used
+        // pages of objects (and their cached values if the value cache is enabled) are kept. The provider owns the objects,
+        // which must stay valid while their page is held. Rows cannot be inserted, removed or moved in this mode,
+        // and read-only values are kept per page.
+        bool hasObjectProvider() const { return _objectProvider ? true : false; }
+        void setObjectProvider(ObjectProviderFunction provider, int rowCount, int pageSize = 256, int maxPages = 8);
         
         // Setters.
-        void setObjects(const QObjectList &objects) { beginResetModel(); _objects = objects; endResetModel(); }
+        void setObjects(const QObjectList &objects) { beginResetModel(); untrackObjects(); clearObjectProvider(); _objects = objects; trackObjects(); endResetModel(); }
         template <class T>
         void setObjects(const QList<T*> &objects);
         template <class T>
@@ -160,7 +521,11 @@ namespace QtPropertyEditor
         QModelIndex parent(const QModelIndex &index) const;
         int rowCount(const QModelIndex &parent = QModelIndex()) const;
         int columnCount(const QModelIndex &parent = QModelIndex()) const;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+        bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+        QVariant liveValue(const QModelIndex &index) const { return QtAbstractPropertyModel::data(index, Qt::EditRole); }
         QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+        QString propertyPathAtIndex(const QModelIndex &index) const;
         bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex());
         bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex());
         bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count, const QModelIndex &destinationParent, int destinationRow);
@@ -173,24 +538,115 @@ namespace QtPropertyEditor
         template <class T>
         static QObject* defaultChildCreator(QObject *parent) { T *object = new T(); object->setParent(parent); return object; }
         
+    public slots:
+        void setShowColumnStats(bool b) { _showColumnStats = b; if(columnCount()) emit headerDataChanged(Qt::Horizontal, 0, columnCount() - 1); }
+        
     signals:
         void rowCountChanged();
         void rowOrderChanged();
+        void exportFinished(const QString &fileName, bool success);
+        
+    protected slots:
+        void objectDestroyed(QObject *object);
+        void removeDestroyedRows();
+        void clearObjectRows() { _objectRows.clear(); }
+        void invalidateCachedValues(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles = QList<int>());
         
     protected:
+        friend class QtPropertyRowsCommand;
+        friend class QtPropertyMoveRowsCommand;
+        
         QObjectList _objects;
         ObjectCreatorFunction _objectCreator = NULL;
+        
+        // Windowed mode pages (least recently used first in _recentPages).
+        struct Page
+        {
+            QObjectList objects;
+            QVector<QVariant> values; // Row major.
+            QBitArray hasValue;
+        };
+        
+        ObjectProviderFunction _objectProvider;
+        int _providerRowCount = 0;
+        int _providerColumnCount = 0;
+        int _pageSize = 256;
+        int _maxPages = 8;
+        mutable QHash<int, Page> _pages;
+        mutable QList<int> _recentPages;
+        
+        Page* page(int row) const;
+        QVariant pageValue(int row, int column) const;
+        QObject* rowObject(int row) const;
+        void clearObjectProvider() { _objectProvider = ObjectProviderFunction(); _providerRowCount = _providerColumnCount = 0; _pages.clear(); _recentPages.clear(); }
+        
+        // Row objects that are destroyed elsewhere are nulled immediately (so they are never dereferenced)
+        // and their rows are removed once control returns to the event loop, one notification per contiguous range.
+        QTimer _removeDestroyedRowsTimer;
+        QMultiHash<QObject*, int> _objectRows; // Rows by object, built on demand and discarded whenever the rows change.
+        void trackObjects(int row = 0, int count = -1);
+        void untrackObjects(int row = 0, int count = -1);
+        bool _showColumnStats = false;
+        
+        // Typed value cache for a column (only the array for the column's storage type is used).
+        // When valid, stats aggregate the numeric values of all cells that are not dirty.
+        struct ValueColumn
+        {
+            enum Storage { DoubleStorage, IntStorage, BoolStorage, StringStorage, VariantStorage };
+            Storage storage = VariantStorage;
+            QVector<double> doubles;
+            QVector<int> ints;
+            QBitArray bools;
+            QVector<int> stringIds; // Into _internedStrings.
+            QVector<QVariant> variants;
+            QBitArray dirty;
+            ColumnStats stats;
+            bool statsValid = false;
+            
+            double numericValue(int row) const; // NaN for non-numeric values.
+            void addToStats(double value);
+            void removeFromStats(double value);
+            void insertRows(int row, int count);
+            void removeRows(int row, int count);
+        };
+        
+        bool _isValueCacheEnabled = false;
+        mutable QVector<ValueColumn> _valueColumns;
+        mutable QStringList _internedStrings;
+        mutable QHash<QString, int> _internedStringIds;
+        mutable int _maxInternedStrings = 4096; // Compacted to the strings still in use when exceeded.
+        
+        ValueColumn& valueColumn(int column) const;
+        void compactInternedStrings() const;
+        void exportHeaders(QStringList *headers, QList<QMetaProperty> *metaProperties) const;
+        static QVariant cellValue(const ValueColumn &valueColumn, const QStringList &internedStrings, int row);
+        void setCellValue(ValueColumn &valueColumn, int row, const QVariant &value) const;
+        
+        // Read-only values are served from the value cache.
+        void storeValues() const Q_DECL_OVERRIDE;
+        void clearValueStore() const Q_DECL_OVERRIDE;
+        void valueStoreRowsInserted(const QModelIndex &parent, int first, int last) Q_DECL_OVERRIDE;
+        void valueStoreRowsRemoved(const QModelIndex &parent, int first, int last) Q_DECL_OVERRIDE;
+        QVariant storedValue(const QModelIndex &index) const Q_DECL_OVERRIDE { return cachedValue(index.row(), index.column()); }
+        
+        // Row changes without undo recording.
+        void insertObjects(int row, const QObjectList &objects);
+        QObjectList takeObjects(int row, int count);
+        int moveObjects(int sourceRow, int count, int destinationRow);
     };
     
     template <class T>
     void QtPropertyTableModel::setObjects(const QList<T*> &objects)
     {
         beginResetModel();
+        untrackObjects();
+        clearObjectProvider();
         _objects.clear();
         foreach(T *object, objects) {
             if(QObject *obj = qobject_cast<QObject*>(object))
                 _objects.append(obj);
         }
+        trackObjects();
         endResetModel();
     }
     
@@ -198,31 +654,266 @@ namespace QtPropertyEditor
     void QtPropertyTableModel::setChildObjects(QObject *parent)
     {
         beginResetModel();
+        untrackObjects();
+        clearObjectProvider();
         _objects.clear();
         foreach(T *derivedObject, parent->findChildren<T*>(QString(), Qt::FindDirectChildrenOnly)) {
             if(QObject *object = qobject_cast<QObject*>(derivedObject))
                 _objects.append(object);
         }
+        trackObjects();
         _objectCreator = std::bind(&QtPropertyTableModel::defaultChildCreator<T>, parent);
         endResetModel();
     }
     
+    /* --------------------------------------------------------------------------------
+     * Columns of a QtStructTableModel (see below).
+     * QtStructMember<&T::field> reads and writes a data member, QtStructMember<&T::field, false> only reads it.
+     * QtStructAccessor<&T::value, &T::setValue> reads and writes via accessor functions (member functions, or free
+     * functions taking the struct), and only reads without a setter. A setter that returns bool can reject a value.
+     * -------------------------------------------------------------------------------- */
+    template <auto Member, bool IsEditable = true>
+    struct QtStructMember
+    {
+        static constexpr bool isEditable = IsEditable;
+        
+        template <class T>
+        static QVariant get(const T &row) { return QVariant::fromValue(row.*Member); }
+        
+        template <class T>
+        static bool set(T &row, const QVariant &value)
+        {
+            if constexpr(IsEditable) {
+                typedef std::remove_cv_t<std::remove_reference_t<decltype(row.*Member)> > V;
+                if(!value.canConvert<V>())
+                    return false;
+                row.*Member = value.value<V>();
+                return true;
+            } else {
+                Q_UNUSED(row);
+                Q_UNUSED(value);
+                return false;
+            }
+        }
+    };
+    
+    template <auto Getter, auto Setter = nullptr>
+    struct QtStructAccessor
+    {
+        static constexpr bool isEditable = !std::is_null_pointer_v<decltype(Setter)>;
+        
+        template <class T>
+        static QVariant get(const T &row) { return QVariant::fromValue(std::invoke(Getter, row)); }
+        
+        template <class T>
+        static bool set(T &row, const QVariant &value)
+        {
+            if constexpr(isEditable) {
+                typedef std::decay_t<std::invoke_result_t<decltype(Getter), const T&> > V;
+                if(!value.canConvert<V>())
+                    return false;
+                if constexpr(std::is_same_v<std::invoke_result_t<decltype(Setter), T&, V>, bool>)
+                    return std::invoke(Setter, row, value.value<V>());
+                std::invoke(Setter, row, value.value<V>());
+                return true;
+            } else {
+                Q_UNUSED(row);
+                Q_UNUSED(value);
+                return false;
+            }
+        }
+    };
+    
+    /* --------------------------------------------------------------------------------
+     * Table model for a std::vector of plain structs (rows are structs, columns are fields), with columns fixed
+     * at compile time, e.g. QtStructTableModel<Particle, QtStructMember<&Particle::mass>, QtStructAccessor<&Particle::charge>>.
+     * A cell is read or written directly through its column's member pointer or accessor (selected by a fold over
+     * the columns), so there are no QObjects, property name lookups or std::function calls.
+     * The vector is not owned and must outlive the model. Works with QtPropertyDelegate and QtPropertyTableEditor.
+     * -------------------------------------------------------------------------------- */
+    template <class T, class... Columns>
+    class QtStructTableModel : public QAbstractTableModel
+    {
+    public:
+        QtStructTableModel(const QStringList &headers = QStringList(), QObject *parent = NULL) : QAbstractTableModel(parent), _headers(headers) {}
+        
+        // Getters.
+        std::vector<T>* rows() const { return _rows; }
+        QStringList headers() const { return _headers; }
+        
+        // Setters.
+        void setRows(std::vector<T> *rows) { beginResetModel(); _rows = rows; endResetModel(); }
+        void setHeaders(const QStringList &headers) { _headers = headers; if(columnCount()) emit headerDataChanged(Qt::Horizontal, 0, columnCount() - 1); }
+        
+        // Call after changing the vector's size or contents directly.
+        void rowsChanged() { beginResetModel(); endResetModel(); }
+        
+        // Model interface.
+        int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE { return (_rows && !parent.isValid()) ? int(_rows->size()) : 0; }
+        int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE { return parent.isValid() ? 0 : int(sizeof...(Columns)); }
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+        bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) Q_DECL_OVERRIDE;
+        Qt::ItemFlags flags(const QModelIndex &index) const Q_DECL_OVERRIDE;
+        QVariant headerData(int section, Qt::Orientation orientation, int role) const Q_DECL_OVERRIDE;
+        
+    protected:
+        std::vector<T> *_rows = NULL;
+        QStringList _headers; // Column number if missing.
+        
+        bool isValidCell(const QModelIndex &index) const { return _rows && index.isValid() && index.row() < int(_rows->size()) && index.column() < int(sizeof...(Columns)); }
+        
+        template <std::size_t... Indexes>
+        static QVariant get(const T &row, int column, std::index_sequence<Indexes...>)
+        {
+            QVariant value;
+            ((int(Indexes) == column && (value = Columns::get(row), true)) || ...);
+            return value;
+        }
+        
+        template <std::size_t... Indexes>
+        static bool set(T &row, int column, const QVariant &value, std::index_sequence<Indexes...>)
+        {
+            bool result = false;
+            ((int(Indexes) == column && (result = Columns::set(row, value), true)) || ...);
+            return result;
+        }
+        
+        template <std::size_t... Indexes>
+        static bool isEditable(int column, std::index_sequence<Indexes...>)
+        {
+            return ((int(Indexes) == column && Columns::isEditable) || ...);
+        }
+    };
+    
+    template <class T, class... Columns>
+    QVariant QtStructTableModel<T, Columns...>::data(const QModelIndex &index, int role) const
+    {
+        if(!isValidCell(index) || (role != Qt::DisplayRole && role != Qt::EditRole))
+            return QVariant();
+        return get((*_rows)[index.row()], index.column(), std::index_sequence_for<Columns...>());
+    }
+    
+    template <class T, class... Columns>
+    bool QtStructTableModel<T, Columns...>::setData(const QModelIndex &index, const QVariant &value, int role)
+    {
+        if(!isValidCell(index) || role != Qt::EditRole)
+            return false;
+        if(!set((*_rows)[index.row()], index.column(), value, std::index_sequence_for<Columns...>()))
+            return false;
+        emit dataChanged(index, index);
+        return true;
+    }
+    
+    template <class T, class... Columns>
+    Qt::ItemFlags QtStructTableModel<T, Columns...>::flags(const QModelIndex &index) const
+    {
+        Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+        if(isValidCell(index) && isEditable(index.column(), std::index_sequence_for<Columns...>()))
+            flags |= Qt::ItemIsEditable;
+        return flags;
+    }
+    
+    template <class T, class... Columns>
+    QVariant QtStructTableModel<T, Columns...>::headerData(int section, Qt::Orientation orientation, int role) const
+    {
+        if(role == Qt::DisplayRole) {
+            if(orientation == Qt::Vertical)
+                return QVariant(section);
+            else if(orientation == Qt::Horizontal && section >= 0 && section < int(sizeof...(Columns)))
+                return section < _headers.size() ? QVariant(_headers.at(section)) : QVariant(section);
+        }
+        return QVariant();
+    }
+    
+    
+    class QtPropertyDelegate;
+    
+    /* --------------------------------------------------------------------------------
+     * Delegate behavior for a value type (see QtPropertyDelegate::registerTypeHandler).
+     * Unset entry points fall back to the default QStyledItemDelegate behavior.
+     * -------------------------------------------------------------------------------- */
+    struct QtPropertyTypeHandler
+    {
+        // Return an editor, or NULL for values that are edited in place via hitTest (e.g. check boxes).
+        typedef std::function<QWidget*(const QtPropertyDelegate *delegate, QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index, const QVariant &value)> CreateFunction;
+        // Show the value in the editor, both when it is opened and when the value changes while it is open.
+        // Unset, the value is written to the editor's user property.
+        typedef std::function<void(QWidget *editor, const QModelIndex &index, const QVariant &value)> SetEditorDataFunction;
+        // Return the value to set from the editor, or an invalid value to fall back to the editor's user property.
+        typedef std::function<QVariant(QWidget *editor, const QModelIndex &index, const QVariant &value)> SetFunction;
+        // Return the text to display (index is invalid when called via QStyledItemDelegate::displayText()).
+        typedef std::function<QString(const QVariant &value, const QModelIndex &index)> FormatFunction;
+        // Return true if the cell was painted (option is already initialized via initStyleOption()).
+        typedef std::function<bool(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index, const QVariant &value)> PaintFunction;
+        // Handle mouse events in the cell. Return true if the event was handled.
+        typedef std::function<bool(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index, const QVariant &value)> HitTestFunction;
+        
+        CreateFunction create;
+        SetEditorDataFunction setEditorData;
+        SetFunction set;
+        FormatFunction format;
+        PaintFunction paint;
+        HitTestFunction hitTest;
+    };
+    
     /* --------------------------------------------------------------------------------
      * Property editor delegate.
+     * Editing, display and painting of values is dispatched to type handlers by meta type id.
      * -------------------------------------------------------------------------------- */
     class QtPropertyDelegate: public QStyledItemDelegate
     {
+        Q_OBJECT
+        
     public:
         QtPropertyDelegate(QWidget *parent = 0) : QStyledItemDelegate(parent) {}
         
+        // Handlers are shared by all delegates. Registering a handler replaces any existing handler for the type,
+        // including the default handlers (bool, double, QSize(F), QPoint(F), QRect(F), QColor and push buttons).
+        // Enums and flags are handled by default without registration. Handlers must be (un)registered in the GUI thread,
+        // and a handler returned by typeHandler() stays valid even if it is replaced or unregistered meanwhile.
+        static void registerTypeHandler(int typeId, const QtPropertyTypeHandler &handler) { typeHandlers().insert(typeId, QSharedPointer<const QtPropertyTypeHandler>(new QtPropertyTypeHandler(handler))); }
+        static void unregisterTypeHandler(int typeId) { typeHandlers().remove(typeId); }
+        QSharedPointer<const QtPropertyTypeHandler> typeHandler(const QModelIndex &index, const QVariant &value) const;
+        
+        
         QWidget* createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
         void setEditorData(QWidget *editor, const QModelIndex &index) const Q_DECL_OVERRIDE;
         void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const Q_DECL_OVERRIDE;
+        void updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
         QString displayText(const QVariant &value, const QLocale &locale) const Q_DECL_OVERRIDE;
         void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
+        
+        // Editors are returned to a pool for reuse instead of being destroyed.
+        void destroyEditor(QWidget *editor, const QModelIndex &index) const Q_DECL_OVERRIDE;
+        
+        // For type handlers: reuse a pooled editor of the given kind if available, else tag a new editor with its kind.
+        QWidget* takePooledEditor(QWidget *parent, const QByteArray &kind) const;
+        QWidget* pooledEditor(QWidget *editor, const QByteArray &kind) const;
+        
+        // Enum keys shared by all enum combo box editors.
+        QStringListModel* enumKeyModel(const QMetaEnum &metaEnum) const;
+        
+    signals:
+        // Some cells of a Ctrl+Enter batch edit could not be set.
+        void editFailed(int numFailed, int numCells);
     
     protected:
+        // Hidden editors available for reuse keyed by editor kind (e.g. "QComboBox:Qt::Alignment").
+        // An editor is reparented to the view that reuses it, and editors deleted along with their view drop out.
+        static const int MaxPooledEditorsPerKind = 4;
+        mutable QHash<QByteArray, QList<QPointer<QWidget> > > _editorPool;
+        mutable QHash<QByteArray, QStringListModel*> _enumKeyModels;
+        
+        // Editor whose pending commit was triggered by Ctrl+Return/Enter.
+        mutable QPointer<QWidget> _applyToSelectionEditor;
+        
+        static QHash<int, QSharedPointer<const QtPropertyTypeHandler> >& typeHandlers();
+        
         bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) Q_DECL_OVERRIDE;
+        bool eventFilter(QObject *object, QEvent *event) Q_DECL_OVERRIDE;
+        
+        // Set value at index, or at all selected cells in the editor's view for a Ctrl+Return/Enter commit.
+        void setModelValue(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index, const QVariant &value) const;
     };
     
     /* --------------------------------------------------------------------------------
@@ -252,6 +943,51 @@ namespace QtPropertyEditor
         QAction *action = NULL;
     };
     
+    /* --------------------------------------------------------------------------------
+     * Polls the values of the cells currently visible in a view (e.g. for properties without NOTIFY signals)
+     * and emits dataChanged only for cells whose value differs from the last value seen. Cells seen for the first time
+     * are only recorded, and the cell being edited is never refreshed (so its editor is not reset while typing).
+     * While a pass exceeds the frame budget the interval doubles (up to 32x the set interval),
+     * and once a pass takes less than half the budget it halves again back down to the set interval.
+     * -------------------------------------------------------------------------------- */
+    class QtPropertyRefreshScheduler : public QObject
+    {
+        Q_OBJECT
+        
+    public:
+        QtPropertyRefreshScheduler(QAbstractItemView *view);
+        
+        // Getters.
+        bool isActive() const { return _isActive; }
+        int interval() const { return _interval; }
+        int frameBudget() const { return _frameBudget; }
+        int currentInterval() const { return _currentInterval; }
+        
+        // Setters (msec).
+        void setInterval(int msec) { _interval = msec; _currentInterval = msec; }
+        void setFrameBudget(int msec) { _frameBudget = msec; }
+        
+    public slots:
+        void start();
+        void stop();
+        void refresh();
+        void clear() { _shownValues.clear(); }
+        
+    protected slots:
+        void poll();
+        
+    protected:
+        QAbstractItemView *_view = NULL;
+        QTimer _timer;
+        bool _isActive = false;
+        int _interval = 200;
+        int _frameBudget = 8;
+        int _currentInterval = 200;
+        QHash<QPersistentModelIndex, size_t> _shownValues; // Value hash of each visible cell as of the last pass.
+        
+        QModelIndexList visibleIndexes() const;
+    };
+    
     /* --------------------------------------------------------------------------------
      * Tree editor for properties in a QObject tree.
      * -------------------------------------------------------------------------------- */
@@ -266,11 +1002,25 @@ namespace QtPropertyEditor
         // However, you're not forced to use this model.
         QtPropertyTreeModel treeModel;
         
+        // Optional polling of visible values (not started by default).
+        QtPropertyRefreshScheduler refreshScheduler;
+        
+        // Batch edits with cells that could not be set emit editFailed() and, unless disabled, show a warning.
+        bool warnOnEditFailure() const { return _warnOnEditFailure; }
+        void setWarnOnEditFailure(bool b) { _warnOnEditFailure = b; }
+        
+    signals:
+        void editFailed(int numFailed, int numCells);
+        
     public slots:
         void resizeColumnsToContents();
+        void reportEditFailure(int numFailed, int numCells);
         
     protected:
         QtPropertyDelegate _delegate;
+        bool _warnOnEditFailure = true;
+        
+        void keyPressEvent(QKeyEvent *event) Q_DECL_OVERRIDE;
     };
     
     
@@ -288,23 +1038,50 @@ namespace QtPropertyEditor
         // However, you're not forced to use this model.
         QtPropertyTableModel tableModel;
         
+        // Optional polling of visible values (not started by default).
+        QtPropertyRefreshScheduler refreshScheduler;
+        
         bool isDynamic() const { return _isDynamic; }
         void setIsDynamic(bool b);
         
         QSize sizeHint() const Q_DECL_OVERRIDE { return getTableSize(this); }
         
+        // Batch edits with cells that could not be set emit editFailed() and, unless disabled, show a warning.
+        bool warnOnEditFailure() const { return _warnOnEditFailure; }
+        void setWarnOnEditFailure(bool b) { _warnOnEditFailure = b; }
+        
+    signals:
+        void editFailed(int numFailed, int numCells);
+        
     public slots:
         void horizontalHeaderContextMenu(QPoint pos);
         void verticalHeaderContextMenu(QPoint pos);
         void appendRow();
         void insertSelectedRows();
         void removeSelectedRows();
+        void applyCurrentValueToSelection();
+        void copySelection();
+        void paste();
         void handleSectionMove(int logicalIndex, int oldVisualIndex, int newVisualIndex);
+        void reportEditFailure(int numFailed, int numCells);
+        
+        // Hide rows without any cells that differ from the model's baseline.
+        // All rows are re-evaluated on reset, only the inserted or changed rows otherwise.
+        void setShowChangedOnly(bool b);
+        void updateHiddenRows();
+        void updateHiddenRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+        void updateInsertedHiddenRows(const QModelIndex &parent, int first, int last);
+        
+        // Rows are sized to their contents, except in windowed mode where all rows have the default height.
+        void updateRowResizeMode();
         
     protected:
         QtPropertyDelegate _delegate;
         bool _isDynamic = true;
+        bool _showChangedOnly = false;
+        bool _warnOnEditFailure = true;
         
+        void updateHiddenRows(int firstRow, int lastRow);
         void keyPressEvent(QKeyEvent *event) Q_DECL_OVERRIDE;
         bool eventFilter(QObject* o, QEvent* e) Q_DECL_OVERRIDE;
     };
@@ -8,7 +8,19 @@
 #include "test_QtPropertyEditor.h"
 
 #include <QApplication>
+#include <QBuffer>
+#include <QClipboard>
+#include <QComboBox>
 #include <QDebug>
+#include <QEventLoop>
+#include <QFile>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QListWidget>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QUndoStack>
+#include <QUrl>
 
 #include "QtPropertyEditor.h"
 
@@ -81,8 +93,782 @@ int testQtPropertyTableEditor(int argc, char **argv)
     return status;
 }
 
+/* --------------------------------------------------------------------------------
+ * Non-interactive checks of the models.
+ * -------------------------------------------------------------------------------- */
+static int numFailedChecks = 0;
+
+#define CHECK(condition) if(!(condition)) { qWarning() << "FAILED:" << #condition << "at line" << __LINE__; ++numFailedChecks; }
+
+// Deferred work (e.g. child object syncs and element writes) runs once control returns to the event loop.
+static void processPendingEvents()
+{
+    for(int i = 0; i < 3; ++i)
+        QCoreApplication::processEvents();
+}
+
+// Value cell of a property row below parent (e.g. an object or a gadget property).
+static QModelIndex propertyIndex(const QtPropertyEditor::QtAbstractPropertyModel &model, const QByteArray &propertyName, const QModelIndex &parent = QModelIndex())
+{
+    for(int row = 0; row < model.rowCount(parent); ++row) {
+        QModelIndex index = model.index(row, 1, parent);
+        if(model.propertyNameAtIndex(index) == propertyName)
+            return index;
+    }
+    return QModelIndex();
+}
+
+// Value cell of the row of an object below parent.
+static QModelIndex objectIndex(const QtPropertyEditor::QtAbstractPropertyModel &model, const QObject *object, const QModelIndex &parent = QModelIndex())
+{
+    for(int row = 0; row < model.rowCount(parent); ++row) {
+        QModelIndex index = model.index(row, 1, parent);
+        if(model.objectAtIndex(index) == object)
+            return index;
+    }
+    return QModelIndex();
+}
+
+// Fetches the lazily inserted children (e.g. gadget fields or container elements) of a value row.
+static QModelIndex fetchedIndex(QtPropertyEditor::QtAbstractPropertyModel &model, const QModelIndex &valueIndex)
+{
+    QModelIndex index = model.index(valueIndex.row(), 0, valueIndex.parent());
+    while(model.canFetchMore(index))
+        model.fetchMore(index);
+    return index;
+}
+
+// Opens an editor at index, sets its value and commits it with Return pressed along with modifiers.
+static bool commitEdit(QAbstractItemView &view, const QModelIndex &index, const QVariant &value, Qt::KeyboardModifiers modifiers)
+{
+    view.selectionModel()->setCurrentIndex(index, QItemSelectionModel::NoUpdate);
+    view.edit(index);
+    QWidget *editor = view.indexWidget(index);
+    if(!editor)
+        return false;
+    editor->setProperty(editor->metaObject()->userProperty().name(), value);
+    QKeyEvent keyEvent(QEvent::KeyPress, Qt::Key_Return, modifiers);
+    QCoreApplication::sendEvent(editor, &keyEvent);
+    processPendingEvents();
+    return true;
+}
+
+static QObjectList newTestObjects(int count)
+{
+    QObjectList objects;
+    for(int i = 0; i < count; ++i) {
+        TestObject *object = new TestObject("My Obj " + QString::number(i), 0, false);
+        object->setMyInt(10 * i);
+        object->setMyDouble(0.5 + i);
+        object->setMyString("str, \"" + QString::number(i) + "\"");
+        object->setMyBool(i % 2);
+        object->setMyEnum(TestObject::MyEnum(i % 3));
+        objects.append(object);
+    }
+    return objects;
+}
+
+void checkExportImportRoundTrip()
+{
+    QObjectList objects = newTestObjects(3);
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myInt, myDouble, myString, myBool, myEnum");
+    model.setObjects(objects);
+    const QtPropertyEditor::QtPropertyTableModel::ExportFormat formats[] = { QtPropertyEditor::QtPropertyTableModel::CsvExport, QtPropertyEditor::QtPropertyTableModel::ColumnarExport };
+    foreach(QtPropertyEditor::QtPropertyTableModel::ExportFormat format, formats) {
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        CHECK(model.exportTable(&buffer, format, 2));
+        buffer.seek(0);
+        QtPropertyEditor::QtPropertyTableModel importedModel;
+        importedModel.setProperties("myInt, myDouble, myString, myBool, myEnum");
+        importedModel.setObjectCreator(QtPropertyEditor::QtPropertyTableModel::defaultCreator<TestObject>);
+        CHECK(importedModel.importTable(&buffer, format, 2) == 3);
+        QObjectList importedObjects = importedModel.objects();
+        CHECK(importedObjects.size() == 3);
+        for(int i = 0; i < importedObjects.size() && i < objects.size(); ++i) {
+            foreach(const QByteArray &propertyName, model.propertyNames)
+                CHECK(importedObjects.at(i)->property(propertyName.constData()) == objects.at(i)->property(propertyName.constData()));
+        }
+        qDeleteAll(importedObjects);
+        if(format == QtPropertyEditor::QtPropertyTableModel::ColumnarExport) {
+            // Only the first complete chunk (2 rows) of a truncated file is imported.
+            QByteArray bytes = buffer.data();
+            bytes.chop(10);
+            QBuffer truncatedBuffer(&bytes);
+            truncatedBuffer.open(QIODevice::ReadOnly);
+            QtPropertyEditor::QtPropertyTableModel truncatedModel;
+            truncatedModel.setProperties("myInt, myDouble, myString, myBool, myEnum");
+            truncatedModel.setObjectCreator(QtPropertyEditor::QtPropertyTableModel::defaultCreator<TestObject>);
+            CHECK(truncatedModel.importTable(&truncatedBuffer, format, 2) == 2);
+            qDeleteAll(truncatedModel.objects());
+        }
+    }
+    qDeleteAll(objects);
+}
+
+void checkUndoRedo()
+{
+    QObjectList objects = newTestObjects(2);
+    TestObject *object = qobject_cast<TestObject*>(objects.first());
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myInt, myDouble");
+    model.setObjects(objects);
+    QUndoStack undoStack;
+    model.setUndoStack(&undoStack);
+    CHECK(model.setData(model.index(0, 0), QVariant(7)));
+    CHECK(object->myInt() == 7);
+    undoStack.undo();
+    CHECK(object->myInt() == 0);
+    undoStack.redo();
+    CHECK(object->myInt() == 7);
+    
+    // Edits that fall outside of the history budget can no longer be undone (the latest one always can).
+    undoStack.clear();
+    model.setUndoByteBudget(1);
+    CHECK(model.setData(model.index(0, 0), QVariant(8)));
+    CHECK(model.setData(model.index(0, 1), QVariant(9.5)));
+    while(undoStack.canUndo())
+        undoStack.undo();
+    CHECK(object->myInt() == 8);
+    CHECK(object->myDouble() == 0.5);
+    model.setUndoStack(NULL);
+    qDeleteAll(objects);
+}
+
+void checkDestroyedRowRemoval()
+{
+    QObjectList objects = newTestObjects(5);
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myInt");
+    model.setObjects(objects);
+    delete objects.takeAt(3);
+    delete objects.takeAt(1);
+    // Destroyed rows are never read and are removed once control returns to the event loop.
+    CHECK(!model.objectAtIndex(model.index(1, 0)));
+    processPendingEvents();
+    CHECK(model.rowCount() == 3);
+    CHECK(model.objects() == objects);
+    CHECK(model.data(model.index(1, 0), Qt::EditRole).toInt() == 20);
+    qDeleteAll(objects);
+}
+
+void checkChildObjectSync()
+{
+    TestObject object("root");
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObject(&object);
+    int numRows = model.rowCount();
+    
+    // Added children are inserted once control returns to the event loop, and removed children are removed immediately.
+    QObject *child = new QObject(&object);
+    child->setObjectName("added");
+    processPendingEvents();
+    CHECK(model.rowCount() == numRows + 1);
+    delete child;
+    CHECK(model.rowCount() == numRows);
+    
+    // Destroyed root objects are removed along with their nodes.
+    TestObject *otherObject = new TestObject("other");
+    model.setRootObjects(QObjectList() << &object << otherObject);
+    CHECK(model.rowCount() == 2);
+    delete otherObject;
+    CHECK(model.rowCount() == 1);
+    CHECK(model.objects() == QObjectList() << &object);
+}
+
+void checkClassGroupOrder()
+{
+    TestObject object("root");
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setShowClassGroups(true);
+    model.setObject(&object);
+    int numRows = model.rowCount();
+    
+    // A new class group is inserted at its class name position, and removed along with its last object.
+    QObject *child = new QObject(&object);
+    child->setObjectName("added");
+    processPendingEvents();
+    CHECK(model.rowCount() == numRows + 1);
+    CHECK(model.data(model.index(numRows - 1, 0)).toString() == "QObject");
+    CHECK(model.data(model.index(numRows, 0)).toString() == "TestObject");
+    delete child;
+    CHECK(model.rowCount() == numRows);
+    CHECK(model.data(model.index(numRows - 1, 0)).toString() == "TestObject");
+}
+
+void checkGadgetWriteBack()
+{
+    TestValueObject object("values");
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObject(&object);
+    
+    // Gadget fields are patched into the property value, which is written back as a whole.
+    QModelIndex gadgetIndex = fetchedIndex(model, propertyIndex(model, "myGadget"));
+    CHECK(model.rowCount(gadgetIndex) == 2);
+    CHECK(model.setData(model.index(0, 1, gadgetIndex), QVariant(5)));
+    CHECK(object.myGadget().width == 5);
+    CHECK(object.myGadget().scale == 1);
+    
+    // Merged field edits are written to every object, keeping each object's other fields.
+    TestValueObject otherObject("other");
+    QtPropertyEditor::QtPropertyTreeModel mergedModel;
+    mergedModel.setObjects(QObjectList() << &object << &otherObject);
+    QModelIndex mergedGadgetIndex = fetchedIndex(mergedModel, propertyIndex(mergedModel, "myGadget"));
+    CHECK(mergedModel.setData(mergedModel.index(1, 1, mergedGadgetIndex), QVariant(2.5)));
+    CHECK(object.myGadget().scale == 2.5);
+    CHECK(otherObject.myGadget().scale == 2.5);
+    CHECK(object.myGadget().width == 5);
+    CHECK(otherObject.myGadget().width == 1);
+}
+
+void checkContainerWriteBack()
+{
+    TestValueObject object("values");
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObject(&object);
+    
+    // Element edits are written back together once control returns to the event loop.
+    QModelIndex listIndex = fetchedIndex(model, propertyIndex(model, "myList"));
+    CHECK(model.rowCount(listIndex) == 3);
+    CHECK(model.setData(model.index(1, 1, listIndex), QVariant(20)));
+    CHECK(model.setData(model.index(2, 1, listIndex), QVariant(30)));
+    CHECK(!model.setData(model.index(0, 1, listIndex), QVariant(QRect(0, 0, 1, 1))));
+    processPendingEvents();
+    CHECK(object.myList() == QList<int>({ 1, 20, 30 }));
+}
+
+void checkMergedObjects()
+{
+    TestObject object("a", 0, false);
+    TestObject otherObject("b", 0, false);
+    otherObject.setMyInt(object.myInt() + 1);
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObjects(QObjectList() << &object << &otherObject);
+    QModelIndex intIndex = propertyIndex(model, "myInt");
+    QModelIndex doubleIndex = propertyIndex(model, "myDouble");
+    CHECK(model.data(intIndex, QtPropertyEditor::QtPropertyTreeModel::MixedValueRole).toBool());
+    CHECK(!model.data(doubleIndex, QtPropertyEditor::QtPropertyTreeModel::MixedValueRole).toBool());
+    
+    // An edit is written to every object, after which the value is no longer mixed.
+    CHECK(model.setData(intIndex, QVariant(3)));
+    CHECK(object.myInt() == 3);
+    CHECK(otherObject.myInt() == 3);
+    CHECK(!model.data(intIndex, QtPropertyEditor::QtPropertyTreeModel::MixedValueRole).toBool());
+}
+
+void checkSnapshotSaveRestore()
+{
+    TestObject object("root");
+    // Same named siblings have distinct paths.
+    TestObject *twin0 = new TestObject("twin", &object, false);
+    TestObject *twin1 = new TestObject("twin", &object, false);
+    twin0->setMyInt(1);
+    twin1->setMyInt(2);
+    object.setMyString("saved");
+    // Beyond the exact integer range of a double.
+    object.setProperty("myDynamicLongLong", QVariant(qint64(9007199254740993LL)));
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObject(&object);
+    const QtPropertyEditor::QtAbstractPropertyModel::SnapshotFormat formats[] = { QtPropertyEditor::QtAbstractPropertyModel::BinarySnapshot, QtPropertyEditor::QtAbstractPropertyModel::JsonSnapshot };
+    foreach(QtPropertyEditor::QtAbstractPropertyModel::SnapshotFormat format, formats) {
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        CHECK(model.saveSnapshot(&buffer, format));
+        // Read-only properties are not saved (the binary format stores paths as UTF-16).
+        if(format == QtPropertyEditor::QtAbstractPropertyModel::JsonSnapshot) {
+            CHECK(buffer.data().contains("myInt"));
+            CHECK(!buffer.data().contains("myReadOnlyInt"));
+        }
+        twin0->setMyInt(0);
+        twin1->setMyInt(0);
+        object.setMyString("changed");
+        object.setProperty("myDynamicLongLong", QVariant(qint64(0)));
+        buffer.seek(0);
+        CHECK(model.restoreSnapshot(&buffer, format));
+        CHECK(twin0->myInt() == 1);
+        CHECK(twin1->myInt() == 2);
+        CHECK(object.myString() == "saved");
+        CHECK(object.property("myDynamicLongLong").toLongLong() == 9007199254740993LL);
+    }
+}
+
+void checkValueCache()
+{
+    QObjectList objects = newTestObjects(3);
+    TestObject *object = qobject_cast<TestObject*>(objects.at(1));
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myInt, myString");
+    model.setObjects(objects);
+    
+    // Without the cache the stats follow changes that were not notified.
+    CHECK(model.columnStats(0).sum == 30);
+    object->setMyInt(100);
+    CHECK(model.columnStats(0).sum == 120);
+    
+    // Cached values (and their stats) only change once the change is notified, but liveValue() reads the object.
+    model.setValueCacheEnabled(true);
+    CHECK(model.data(model.index(1, 0)).toInt() == 100);
+    CHECK(model.columnStats(0).max == 100);
+    object->setMyInt(5);
+    object->setMyString("changed");
+    CHECK(model.data(model.index(1, 0)).toInt() == 100);
+    CHECK(model.liveValue(model.index(1, 0)).toInt() == 5);
+    emit model.dataChanged(model.index(1, 0), model.index(1, 1));
+    CHECK(model.data(model.index(1, 0)).toInt() == 5);
+    CHECK(model.data(model.index(1, 1)).toString() == "changed");
+    CHECK(model.columnStats(0).max == 20);
+    CHECK(model.columnStats(0).sum == 25);
+    
+    // Inserted and removed rows are shifted in or out of the cache (removed objects are deleted by the model).
+    model.setObjectCreator(QtPropertyEditor::QtPropertyTableModel::defaultCreator<TestObject>);
+    CHECK(model.insertRows(0, 1));
+    CHECK(model.data(model.index(0, 0)).toInt() == 82);
+    CHECK(model.data(model.index(2, 0)).toInt() == 5);
+    CHECK(model.columnStats(0).sum == 107);
+    CHECK(model.removeRows(0, 1));
+    CHECK(model.data(model.index(1, 0)).toInt() == 5);
+    CHECK(model.columnStats(0).sum == 25);
+    qDeleteAll(objects);
+}
+
+void checkObjectProvider()
+{
+    QObjectList objects = newTestObjects(10);
+    int numProvidedPages = 0;
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myInt");
+    model.setObjectProvider([&](int firstRow, int count) { ++numProvidedPages; return objects.mid(firstRow, count); }, objects.size(), 2, 2);
+    CHECK(model.rowCount() == 10);
+    CHECK(model.data(model.index(9, 0)).toInt() == 90);
+    CHECK(model.data(model.index(4, 0)).toInt() == 40);
+    
+    // Only the most recently used pages are held, so an evicted page is pulled again.
+    CHECK(model.data(model.index(0, 0)).toInt() == 0);
+    int numPages = numProvidedPages;
+    CHECK(model.data(model.index(8, 0)).toInt() == 80);
+    CHECK(numProvidedPages == numPages + 1);
+    
+    // Column stats only cover the held pages (rows 0, 1, 8 and 9) and pull no pages.
+    numPages = numProvidedPages;
+    QtPropertyEditor::QtPropertyTableModel::ColumnStats stats = model.columnStats(0);
+    CHECK(stats.count == 4);
+    CHECK(stats.sum == 180);
+    CHECK(numProvidedPages == numPages);
+    model.setObjectProvider(QtPropertyEditor::QtPropertyTableModel::ObjectProviderFunction(), 0);
+    qDeleteAll(objects);
+}
+
+void checkReadOnlyStore()
+{
+    TestObject object("root");
+    TestValueObject *valueObject = new TestValueObject("values", &object);
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObject(&object);
+    model.setReadOnly(true);
+    QModelIndex intIndex = propertyIndex(model, "myInt");
+    CHECK(model.data(intIndex).toInt() == 82);
+    CHECK(!(model.flags(intIndex) & Qt::ItemIsEditable));
+    CHECK(!model.setData(intIndex, QVariant(1)));
+    
+    // Stored values are served until refreshValues(), also after rows are fetched or inserted.
+    object.setMyInt(1);
+    CHECK(model.data(intIndex).toInt() == 82);
+    QModelIndex valueObjectIndex = objectIndex(model, valueObject);
+    QModelIndex listIndex = fetchedIndex(model, propertyIndex(model, "myList", valueObjectIndex.sibling(valueObjectIndex.row(), 0)));
+    CHECK(model.rowCount(listIndex) == 3);
+    valueObject->setMyList(QList<int>({ 7, 8, 9 }));
+    CHECK(model.data(model.index(1, 1, listIndex)).toInt() == 2);
+    QObject *child = new QObject(&object);
+    child->setObjectName("added");
+    processPendingEvents();
+    CHECK(model.data(intIndex).toInt() == 82);
+    CHECK(model.data(model.index(1, 1, listIndex)).toInt() == 2);
+    
+    // Inserted object rows store their own values, and the values of removed rows are dropped.
+    QModelIndex childIndex = objectIndex(model, child);
+    CHECK(childIndex.isValid());
+    child->setObjectName("renamed");
+    CHECK(model.data(childIndex).toString() == "added");
+    delete child;
+    CHECK(model.data(intIndex).toInt() == 82);
+    
+    model.refreshValues();
+    CHECK(model.data(intIndex).toInt() == 1);
+    CHECK(model.data(model.index(1, 1, listIndex)).toInt() == 8);
+}
+
+void checkStructTableModel()
+{
+    std::vector<TestStruct> rows(2);
+    rows[1].mass = 3;
+    rows[1].name = "second";
+    using namespace QtPropertyEditor;
+    QtStructTableModel<TestStruct, QtStructMember<&TestStruct::mass>, QtStructMember<&TestStruct::name, false>, QtStructAccessor<&TestStruct::energy>, QtStructAccessor<&TestStruct::count, &TestStruct::setCount> > model({ "Mass", "Name" });
+    model.setRows(&rows);
+    CHECK(model.rowCount() == 2);
+    CHECK(model.columnCount() == 4);
+    CHECK(model.headerData(1, Qt::Horizontal, Qt::DisplayRole).toString() == "Name");
+    CHECK(model.headerData(3, Qt::Horizontal, Qt::DisplayRole).toInt() == 3);
+    CHECK(model.data(model.index(1, 0)).toDouble() == 3);
+    CHECK(model.data(model.index(1, 1)).toString() == "second");
+    CHECK(model.data(model.index(1, 2)).toDouble() == 6);
+    
+    // Read-only columns are neither editable nor set.
+    CHECK(model.flags(model.index(0, 0)) & Qt::ItemIsEditable);
+    CHECK(!(model.flags(model.index(0, 1)) & Qt::ItemIsEditable));
+    CHECK(!(model.flags(model.index(0, 2)) & Qt::ItemIsEditable));
+    CHECK(model.flags(model.index(0, 3)) & Qt::ItemIsEditable);
+    CHECK(model.setData(model.index(0, 0), QVariant(2.5)));
+    CHECK(rows[0].mass == 2.5);
+    CHECK(model.data(model.index(0, 2)).toDouble() == 5);
+    CHECK(!model.setData(model.index(0, 1), QVariant(QString("renamed"))));
+    CHECK(rows[0].name.isEmpty());
+    
+    // Setters that return bool can reject a value.
+    CHECK(model.setData(model.index(0, 3), QVariant(4)));
+    CHECK(rows[0].count() == 4);
+    CHECK(!model.setData(model.index(0, 3), QVariant(-1)));
+    CHECK(rows[0].count() == 4);
+}
+
+void checkSelectionEdit()
+{
+    QObjectList objects = newTestObjects(3);
+    QtPropertyEditor::QtPropertyTableEditor editor;
+    editor.setWarnOnEditFailure(false);
+    editor.tableModel.setProperties("myInt, myDouble");
+    editor.tableModel.setObjects(objects);
+    editor.show();
+    QModelIndex index = editor.tableModel.index(0, 0);
+    editor.selectionModel()->select(QItemSelection(index, editor.tableModel.index(2, 0)), QItemSelectionModel::ClearAndSelect);
+    // Ctrl+Return applies the edited value to the whole selection.
+    CHECK(commitEdit(editor, index, QVariant(42), Qt::ControlModifier));
+    foreach(QObject *object, objects)
+        CHECK(object->property("myInt").toInt() == 42);
+    // Any other commit only sets the edited cell.
+    CHECK(commitEdit(editor, index, QVariant(7), Qt::NoModifier));
+    CHECK(objects.at(0)->property("myInt").toInt() == 7);
+    CHECK(objects.at(1)->property("myInt").toInt() == 42);
+    CHECK(objects.at(2)->property("myInt").toInt() == 42);
+    qDeleteAll(objects);
+}
+
+void checkBackgroundExport()
+{
+    QObjectList objects = newTestObjects(5);
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myInt, myDouble, myString");
+    model.setObjects(objects);
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("export.csv");
+    QEventLoop loop;
+    bool isFinished = false;
+    bool success = false;
+    QObject::connect(&model, &QtPropertyEditor::QtPropertyTableModel::exportFinished, &loop, [&](const QString &, bool ok) {
+        isFinished = true;
+        success = ok;
+        loop.quit();
+    });
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+    model.exportTableInBackground(fileName, QtPropertyEditor::QtPropertyTableModel::CsvExport, 2);
+    loop.exec();
+    CHECK(isFinished && success);
+    QFile file(fileName);
+    CHECK(file.open(QIODevice::ReadOnly));
+    QtPropertyEditor::QtPropertyTableModel importedModel;
+    importedModel.setProperties("myInt, myDouble, myString");
+    importedModel.setObjectCreator(QtPropertyEditor::QtPropertyTableModel::defaultCreator<TestObject>);
+    CHECK(importedModel.importTable(&file, QtPropertyEditor::QtPropertyTableModel::CsvExport) == 5);
+    QObjectList importedObjects = importedModel.objects();
+    for(int i = 0; i < importedObjects.size() && i < objects.size(); ++i)
+        CHECK(importedObjects.at(i)->property("myString") == objects.at(i)->property("myString"));
+    qDeleteAll(importedObjects);
+    // Destroying the model cancels a running export instead of leaving its thread blocked.
+    QtPropertyEditor::QtPropertyTableModel *cancelledModel = new QtPropertyEditor::QtPropertyTableModel;
+    cancelledModel->setProperties("myInt");
+    cancelledModel->setObjects(objects);
+    cancelledModel->exportTableInBackground(dir.filePath("cancelled.csv"), QtPropertyEditor::QtPropertyTableModel::CsvExport, 1);
+    delete cancelledModel;
+    processPendingEvents();
+    qDeleteAll(objects);
+}
+
+void checkTypeHandlers()
+{
+    QObjectList objects = newTestObjects(2);
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myEnum");
+    model.setObjects(objects);
+    QtPropertyEditor::QtPropertyDelegate delegate;
+    // Enums are rendered by key without registration.
+    QModelIndex index = model.index(1, 0);
+    QSharedPointer<const QtPropertyEditor::QtPropertyTypeHandler> enumHandler = delegate.typeHandler(index, index.data(Qt::DisplayRole));
+    CHECK(enumHandler && enumHandler->format && enumHandler->format(index.data(Qt::DisplayRole), index) == "B");
+    // A registered handler is used, and stays valid after it is unregistered.
+    QtPropertyEditor::QtPropertyTypeHandler handler;
+    handler.format = [](const QVariant &value, const QModelIndex &) { return QString("url:") + value.toUrl().host(); };
+    QtPropertyEditor::QtPropertyDelegate::registerTypeHandler(QMetaType::QUrl, handler);
+    QVariant url = QVariant(QUrl("http://example.com"));
+    CHECK(delegate.displayText(url, QLocale()) == "url:example.com");
+    QSharedPointer<const QtPropertyEditor::QtPropertyTypeHandler> urlHandler = delegate.typeHandler(QModelIndex(), url);
+    QtPropertyEditor::QtPropertyDelegate::unregisterTypeHandler(QMetaType::QUrl);
+    CHECK(!delegate.typeHandler(QModelIndex(), url));
+    CHECK(urlHandler && urlHandler->format(url, QModelIndex()) == "url:example.com");
+    qDeleteAll(objects);
+}
+
+void checkPaste()
+{
+    QObjectList objects = newTestObjects(3);
+    QtPropertyEditor::QtPropertyTableEditor editor;
+    editor.setWarnOnEditFailure(false);
+    editor.tableModel.setProperties("myInt, myString");
+    editor.tableModel.setObjects(objects);
+    // Tab separated rows with a quoted field are pasted from the current cell on.
+    editor.setCurrentIndex(editor.tableModel.index(0, 0));
+    QApplication::clipboard()->setText("1\t\"a\tb\"\n2\tc\n");
+    editor.paste();
+    CHECK(objects.at(0)->property("myInt").toInt() == 1);
+    CHECK(objects.at(0)->property("myString").toString() == "a\tb");
+    CHECK(objects.at(1)->property("myInt").toInt() == 2);
+    CHECK(objects.at(1)->property("myString").toString() == "c");
+    // Comma separated text without a trailing newline.
+    editor.setCurrentIndex(editor.tableModel.index(2, 0));
+    QApplication::clipboard()->setText("5,\"x, \"\"y\"\"\"");
+    editor.paste();
+    CHECK(objects.at(2)->property("myInt").toInt() == 5);
+    CHECK(objects.at(2)->property("myString").toString() == "x, \"y\"");
+    // A single value fills the selection.
+    editor.selectionModel()->select(QItemSelection(editor.tableModel.index(0, 0), editor.tableModel.index(2, 0)), QItemSelectionModel::ClearAndSelect);
+    QApplication::clipboard()->setText("9");
+    editor.paste();
+    foreach(QObject *object, objects)
+        CHECK(object->property("myInt").toInt() == 9);
+    qDeleteAll(objects);
+}
+
+void checkRefreshScheduler()
+{
+    QObjectList objects = newTestObjects(2);
+    QList<QModelIndex> changedIndexes;
+    QtPropertyEditor::QtPropertyTableEditor editor;
+    editor.tableModel.setProperties("myInt");
+    editor.tableModel.setValueCacheEnabled(true);
+    editor.tableModel.setObjects(objects);
+    editor.show();
+    processPendingEvents();
+    QObject::connect(&editor.tableModel, &QAbstractItemModel::dataChanged, [&](const QModelIndex &topLeft) { changedIndexes.append(topLeft); });
+    // Cells seen for the first time are only recorded.
+    editor.refreshScheduler.refresh();
+    CHECK(changedIndexes.isEmpty());
+    // A change without a NOTIFY signal is detected even though the value is cached.
+    qobject_cast<TestObject*>(objects.at(0))->setMyInt(123);
+    editor.refreshScheduler.refresh();
+    CHECK(changedIndexes.size() == 1 && changedIndexes.value(0) == editor.tableModel.index(0, 0));
+    CHECK(editor.tableModel.index(0, 0).data(Qt::EditRole).toInt() == 123);
+    // The cell being edited is left alone.
+    changedIndexes.clear();
+    editor.setCurrentIndex(editor.tableModel.index(1, 0));
+    editor.edit(editor.tableModel.index(1, 0));
+    qobject_cast<TestObject*>(objects.at(1))->setMyInt(456);
+    editor.refreshScheduler.refresh();
+    CHECK(changedIndexes.isEmpty());
+    qDeleteAll(objects);
+}
+
+void checkColumnStats()
+{
+    QObjectList objects = newTestObjects(4);
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myDouble, myString");
+    model.setValueCacheEnabled(true);
+    model.setObjects(objects);
+    CHECK(model.isNumericColumn(0));
+    CHECK(!model.isNumericColumn(1));
+    QtPropertyEditor::QtPropertyTableModel::ColumnStats stats = model.columnStats(0);
+    CHECK(stats.count == 4 && stats.min == 0.5 && stats.max == 3.5 && stats.sum == 8 && stats.mean() == 2);
+    // Edits update the stats, including when the current max is replaced.
+    CHECK(model.setData(model.index(3, 0), QVariant(-1.0)));
+    stats = model.columnStats(0);
+    CHECK(stats.count == 4 && stats.min == -1 && stats.max == 2.5 && stats.sum == 3.5);
+    // Shown as header tool tips for numeric columns only.
+    model.setShowColumnStats(true);
+    CHECK(model.headerData(0, Qt::Horizontal, Qt::ToolTipRole).toString().contains("max: 2.5"));
+    CHECK(!model.headerData(1, Qt::Horizontal, Qt::ToolTipRole).isValid());
+    qDeleteAll(objects);
+}
+
+void checkBaselineDiff()
+{
+    QObjectList objects = newTestObjects(2);
+    TestObject *object = qobject_cast<TestObject*>(objects.at(0));
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObject(object);
+    // Before and after: only edited properties differ from the baseline.
+    model.captureBaseline();
+    CHECK(model.hasBaseline());
+    CHECK(!model.isChangedFromBaseline(propertyIndex(model, "myInt")));
+    CHECK(model.setData(propertyIndex(model, "myInt"), QVariant(99)));
+    CHECK(model.isChangedFromBaseline(propertyIndex(model, "myInt")));
+    CHECK(propertyIndex(model, "myInt").data(QtPropertyEditor::QtAbstractPropertyModel::ValueChangedRole).toBool());
+    CHECK(!model.isChangedFromBaseline(propertyIndex(model, "myDouble")));
+    // Only changed properties get rows.
+    model.setShowChangedOnly(true);
+    CHECK(propertyIndex(model, "myInt").isValid());
+    CHECK(!propertyIndex(model, "myDouble").isValid());
+    model.setShowChangedOnly(false);
+    // Two objects: the baseline is taken from a model of the other object.
+    QtPropertyEditor::QtPropertyTreeModel otherModel;
+    otherModel.setObject(objects.at(1));
+    model.captureBaseline(&otherModel);
+    CHECK(model.isChangedFromBaseline(propertyIndex(model, "myDouble")));
+    CHECK(!model.isChangedFromBaseline(propertyIndex(model, "myFloat")));
+    model.clearBaseline();
+    CHECK(!model.isChangedFromBaseline(propertyIndex(model, "myInt")));
+    qDeleteAll(objects);
+}
+
+void checkEditorPool()
+{
+    QObjectList objects = newTestObjects(2);
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("myEnum, myInt");
+    model.setObjects(objects);
+    QtPropertyEditor::QtPropertyDelegate delegate;
+    QWidget parent;
+    QStyleOptionViewItem option;
+    // Enum editors share one prebuilt model of the enum's keys.
+    QComboBox *comboBox = qobject_cast<QComboBox*>(delegate.createEditor(&parent, option, model.index(0, 0)));
+    CHECK(comboBox && comboBox->count() == 3 && comboBox->itemText(1) == "B");
+    QComboBox *otherComboBox = qobject_cast<QComboBox*>(delegate.createEditor(&parent, option, model.index(1, 0)));
+    CHECK(comboBox && otherComboBox && otherComboBox != comboBox && otherComboBox->model() == comboBox->model());
+    // Closed editors are reused instead of being recreated.
+    delegate.destroyEditor(otherComboBox, model.index(1, 0));
+    CHECK(delegate.createEditor(&parent, option, model.index(1, 0)) == otherComboBox);
+    QWidget *spinBox = delegate.createEditor(&parent, option, model.index(0, 1));
+    delegate.destroyEditor(spinBox, model.index(0, 1));
+    CHECK(spinBox && delegate.createEditor(&parent, option, model.index(1, 1)) == spinBox);
+    qDeleteAll(objects);
+}
+
+void checkFlagEditing()
+{
+    QLabel label;
+    label.setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    QtPropertyEditor::QtPropertyTableModel model;
+    model.setProperties("alignment");
+    model.setObjects(QObjectList() << &label);
+    QtPropertyEditor::QtPropertyDelegate delegate;
+    QModelIndex index = model.index(0, 0);
+    QVariant value = index.data(Qt::DisplayRole);
+    // Combined masks are rendered like QMetaEnum::valueToKeys().
+    const QMetaEnum metaEnum = label.metaObject()->property(label.metaObject()->indexOfProperty("alignment")).enumerator();
+    QSharedPointer<const QtPropertyEditor::QtPropertyTypeHandler> handler = delegate.typeHandler(index, value);
+    CHECK(handler && handler->format && handler->format(value, index) == QString(metaEnum.valueToKeys(int(label.alignment()))));
+    // The editor checks the flags that are set, and the checked flags are combined.
+    QWidget parent;
+    QListWidget *editor = qobject_cast<QListWidget*>(delegate.createEditor(&parent, QStyleOptionViewItem(), index));
+    CHECK(editor);
+    if(editor) {
+        delegate.setEditorData(editor, index);
+        QList<QListWidgetItem*> topItems = editor->findItems("AlignTop", Qt::MatchExactly);
+        QList<QListWidgetItem*> bottomItems = editor->findItems("AlignBottom", Qt::MatchExactly);
+        CHECK(topItems.size() == 1 && topItems.first()->checkState() == Qt::Checked);
+        CHECK(bottomItems.size() == 1 && bottomItems.first()->checkState() == Qt::Unchecked);
+        if(topItems.size() == 1 && bottomItems.size() == 1) {
+            topItems.first()->setCheckState(Qt::Unchecked);
+            bottomItems.first()->setCheckState(Qt::Checked);
+            delegate.setModelData(editor, &model, index);
+            CHECK(label.alignment() == (Qt::AlignLeft | Qt::AlignBottom));
+        }
+    }
+}
+
+void checkColorText()
+{
+    // Colors round trip through the same text as shown in the cell and edited in the line edit.
+    QColor color(10, 20, 30, 40);
+    QString text = QtPropertyEditor::valueToText(QVariant(color));
+    CHECK(text == "(10, 20, 30, 40)");
+    bool ok = false;
+    CHECK(QtPropertyEditor::valueFromText(text, QMetaType::QColor, QMetaProperty(), &ok).value<QColor>() == color && ok);
+    CHECK(QtPropertyEditor::valueFromText("(1, 2, 3)", QMetaType::QColor).value<QColor>() == QColor(1, 2, 3));
+    CHECK(QtPropertyEditor::valueFromText("#ff0000", QMetaType::QColor).value<QColor>() == QColor(Qt::red));
+    QtPropertyEditor::valueFromText("(256, 0, 0)", QMetaType::QColor, QMetaProperty(), &ok);
+    CHECK(!ok);
+    // The delegate displays colors by the same text.
+    QtPropertyEditor::QtPropertyDelegate delegate;
+    CHECK(delegate.displayText(QVariant(color), QLocale()) == text);
+}
+
+void checkReferenceExpansion()
+{
+    TestObject object("object", 0, false);
+    TestObject peer("peer", 0, false);
+    peer.setMyInt(5);
+    object.setProperty("peer", QVariant::fromValue<QObject*>(&peer));
+    peer.setProperty("back", QVariant::fromValue<QObject*>(&object));
+    QtPropertyEditor::QtPropertyTreeModel model;
+    model.setObject(&object);
+    // The referenced object is only resolved when the reference is expanded.
+    QModelIndex peerIndex = propertyIndex(model, "peer");
+    QModelIndex referenceIndex = model.index(peerIndex.row(), 0);
+    CHECK(model.hasChildren(referenceIndex) && model.rowCount(referenceIndex) == 0);
+    referenceIndex = fetchedIndex(model, peerIndex);
+    CHECK(model.rowCount(referenceIndex) == 1);
+    QModelIndex targetIndex = model.index(0, 0, referenceIndex);
+    CHECK(model.objectAtIndex(targetIndex) == &peer);
+    CHECK(propertyIndex(model, "myInt", targetIndex).data(Qt::EditRole).toInt() == 5);
+    // A reference back to an object on the path from the root is not expanded again.
+    QModelIndex backIndex = propertyIndex(model, "back", targetIndex);
+    CHECK(backIndex.isValid() && !model.hasChildren(model.index(backIndex.row(), 0, targetIndex)));
+    // An expanded reference is collapsed once it refers to another object.
+    object.setProperty("peer", QVariant::fromValue<QObject*>(NULL));
+    emit model.dataChanged(peerIndex, peerIndex);
+    CHECK(model.rowCount(model.index(peerIndex.row(), 0)) == 0);
+}
+
+int testQtPropertyModels(int argc, char **argv)
+{
+    QApplication app(argc, argv);
+    
+    checkExportImportRoundTrip();
+    checkUndoRedo();
+    checkDestroyedRowRemoval();
+    checkChildObjectSync();
+    checkClassGroupOrder();
+    checkGadgetWriteBack();
+    checkContainerWriteBack();
+    checkMergedObjects();
+    checkSnapshotSaveRestore();
+    checkValueCache();
+    checkObjectProvider();
+    checkReadOnlyStore();
+    checkStructTableModel();
+    checkSelectionEdit();
+    checkBackgroundExport();
+    checkTypeHandlers();
+    checkPaste();
+    checkRefreshScheduler();
+    checkColumnStats();
+    checkBaselineDiff();
+    checkEditorPool();
+    checkFlagEditing();
+    checkColorText();
+    checkReferenceExpansion();
+    
+    qDebug() << numFailedChecks << "failed checks";
+    return numFailedChecks;
+}
+
 int main(int argc, char **argv)
 {
+    // Pass --no-gui to only run the non-interactive checks (they still need a platform, e.g. QT_QPA_PLATFORM=offscreen).
+    if(testQtPropertyModels(argc, argv))
+        return 1;
+    if(argc > 1 && QString(argv[1]) == "--no-gui")
+        return 0;
     testQtPropertyTreeEditor(argc, argv);
     testQtPropertyTableEditor(argc, argv);
     return 0;
@@ -9,6 +9,7 @@
 #define __test_QtPropertyEditor_H__
 
 #include <QDateTime>
+#include <QList>
 #include <QObject>
 #include <QPoint>
 #include <QPointF>
@@ -105,4 +106,61 @@ protected:
     QRectF _myRectF;
 };
 
+/* --------------------------------------------------------------------------------
+ * Q_GADGET value type with some fields.
+ * -------------------------------------------------------------------------------- */
+struct TestGadget
+{
+    Q_GADGET
+    Q_PROPERTY(int width MEMBER width)
+    Q_PROPERTY(double scale MEMBER scale)
+    
+public:
+    int width = 1;
+    double scale = 1;
+    
+    bool operator==(const TestGadget &other) const { return width == other.width && scale == other.scale; }
+    bool operator!=(const TestGadget &other) const { return !(*this == other); }
+};
+
+/* --------------------------------------------------------------------------------
+ * QObject derived class with gadget and container properties.
+ * -------------------------------------------------------------------------------- */
+class TestValueObject : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(TestGadget myGadget READ myGadget WRITE setMyGadget)
+    Q_PROPERTY(QList<int> myList READ myList WRITE setMyList)
+    
+public:
+    TestValueObject(const QString &name = "", QObject *parent = 0) : QObject(parent), _myList({ 1, 2, 3 }) { setObjectName(name); }
+    
+    TestGadget myGadget() const { return _myGadget; }
+    QList<int> myList() const { return _myList; }
+    
+    void setMyGadget(TestGadget myGadget) { _myGadget = myGadget; }
+    void setMyList(QList<int> myList) { _myList = myList; }
+    
+protected:
+    TestGadget _myGadget;
+    QList<int> _myList;
+};
+
+/* --------------------------------------------------------------------------------
+ * Plain struct for the struct table model.
+ * -------------------------------------------------------------------------------- */
+struct TestStruct
+{
+    double mass = 1;
+    int charge = 0;
+    QString name;
+    
+    double energy() const { return 2 * mass; }
+    int count() const { return _count; }
+    bool setCount(int count) { if(count < 0) return false; _count = count; return true; }
+    
+protected:
+    int _count = 0;
+};
+
 #endif // __test_QtPropertyEditor_H__